@@ -0,0 +1,733 @@
+#define FUSE_USE_VERSION 35
+#include "FS.h"
+#include "Utils.h"
+#include "Inode.h"
+#include "Logger.h"
+#include <fuse3/fuse_lowlevel.h>
+#include <sys/stat.h>
+#include <cstring>
+#include <cstdlib>
+#include <ctime>
+#include <limits>
+#include <vector>
+
+FS g_FileSystem;
+double g_EntryTimeout = FUSE_ENTRY_TIMEOUT_SECONDS;
+double g_AttrTimeout = FUSE_ATTR_TIMEOUT_SECONDS;
+
+static void replyError(fuse_req_t req, ErrorCode err)
+{
+	fuse_reply_err(req, -errorCodeToInt(err));
+}
+
+static bool fillEntry(Ino inodeNumber, fuse_entry_param &entry, ErrorCode &outError)
+{
+	std::memset(&entry, 0, sizeof(fuse_entry_param));
+	entry.attr = g_FileSystem.getFileStat(inodeNumber, outError);
+	if (outError != SUCCESS)
+	{
+		return false;
+	}
+	entry.ino = inodeNumber;
+	entry.attr_timeout = g_AttrTimeout;
+	entry.entry_timeout = g_EntryTimeout;
+	return true;
+}
+
+static void replyEntry(fuse_req_t req, Ino inodeNumber)
+{
+	fuse_entry_param entry;
+	ErrorCode err;
+	if (!fillEntry(inodeNumber, entry, err))
+	{
+		g_FileSystem.forgetInode(inodeNumber, 1);
+		replyError(req, err);
+		return;
+	}
+	fuse_reply_entry(req, &entry);
+}
+
+static bool getRequestOwner(fuse_req_t req, uint16_t &outUID, uint16_t &outGID)
+{
+	const fuse_ctx *ctx = fuse_req_ctx(req);
+	if (ctx->uid > std::numeric_limits<uint16_t>::max() || ctx->gid > std::numeric_limits<uint16_t>::max())
+	{
+		return false;
+	}
+	outUID = static_cast<uint16_t>(ctx->uid);
+	outGID = static_cast<uint16_t>(ctx->gid);
+	return true;
+}
+
+static void ll_init(void *userdata, fuse_conn_info *conn)
+{
+	conn->want |= conn->capable & FUSE_CAP_READDIRPLUS;
+	conn->want |= conn->capable & FUSE_CAP_PARALLEL_DIROPS;
+	Logger::log("Filesystem initialized", LOG_INFO);
+}
+
+static void ll_destroy(void *userdata)
+{
+	Logger::log("Filesystem destroyed", LOG_INFO);
+	g_FileSystem.unmount();
+}
+
+static void ll_lookup(fuse_req_t req, fuse_ino_t parent, const char *name)
+{
+	Logger::log(std::string("lookup called for parent: ") + std::to_string(parent) + ", name: " + name, LOG_DEBUG);
+	ErrorCode err;
+	Ino inodeNumber = g_FileSystem.lookup(parent, name, err);
+	if (err == ERROR_FILE_NOT_FOUND)
+	{
+		fuse_entry_param entry;
+		std::memset(&entry, 0, sizeof(fuse_entry_param));
+		entry.entry_timeout = g_EntryTimeout;
+		fuse_reply_entry(req, &entry);
+		return;
+	}
+	if (err != SUCCESS)
+	{
+		replyError(req, err);
+		return;
+	}
+	replyEntry(req, inodeNumber);
+}
+
+static void ll_forget(fuse_req_t req, fuse_ino_t ino, uint64_t nlookup)
+{
+	Logger::log(std::string("forget called for inode: ") + std::to_string(ino) + ", nlookup: " + std::to_string(nlookup), LOG_DEBUG);
+	g_FileSystem.forgetInode(ino, nlookup);
+	fuse_reply_none(req);
+}
+
+static void ll_forget_multi(fuse_req_t req, size_t count, fuse_forget_data *forgets)
+{
+	Logger::log(std::string("forget_multi called for count: ") + std::to_string(count), LOG_DEBUG);
+	for (size_t i = 0; i < count; i++)
+	{
+		g_FileSystem.forgetInode(forgets[i].ino, forgets[i].nlookup);
+	}
+	fuse_reply_none(req);
+}
+
+static void ll_getattr(fuse_req_t req, fuse_ino_t ino, fuse_file_info *fi)
+{
+	Logger::log(std::string("getattr called for inode: ") + std::to_string(ino), LOG_DEBUG);
+	ErrorCode err;
+	struct stat st = g_FileSystem.getFileStat(ino, err);
+	if (err != SUCCESS)
+	{
+		replyError(req, err);
+		return;
+	}
+	fuse_reply_attr(req, &st, g_AttrTimeout);
+}
+
+static void ll_setattr(fuse_req_t req, fuse_ino_t ino, struct stat *attr, int to_set, fuse_file_info *fi)
+{
+	Logger::log(std::string("setattr called for inode: ") + std::to_string(ino) + ", to_set: " + std::to_string(to_set), LOG_DEBUG);
+	FS &fs = g_FileSystem;
+	ErrorCode err;
+	if (to_set & FUSE_SET_ATTR_MODE)
+	{
+		err = fs.chmod(ino, static_cast<uint16_t>(attr->st_mode));
+		if (err != SUCCESS)
+		{
+			replyError(req, err);
+			return;
+		}
+	}
+	if (to_set & (FUSE_SET_ATTR_UID | FUSE_SET_ATTR_GID))
+	{
+		bool updateUID = (to_set & FUSE_SET_ATTR_UID) != 0;
+		bool updateGID = (to_set & FUSE_SET_ATTR_GID) != 0;
+		if ((updateUID && attr->st_uid > std::numeric_limits<uint16_t>::max()) || (updateGID && attr->st_gid > std::numeric_limits<uint16_t>::max()))
+		{
+			fuse_reply_err(req, EOVERFLOW);
+			return;
+		}
+		err = fs.chown(ino, static_cast<uint16_t>(attr->st_uid), static_cast<uint16_t>(attr->st_gid), updateUID, updateGID);
+		if (err != SUCCESS)
+		{
+			replyError(req, err);
+			return;
+		}
+	}
+	if (to_set & FUSE_SET_ATTR_SIZE)
+	{
+		if (attr->st_size < 0 || attr->st_size > MINIX3_MAX_FILE_SIZE)
+		{
+			fuse_reply_err(req, EFBIG);
+			return;
+		}
+		err = fs.truncateFile(ino, static_cast<uint32_t>(attr->st_size));
+		if (err != SUCCESS)
+		{
+			replyError(req, err);
+			return;
+		}
+	}
+	if (to_set & (FUSE_SET_ATTR_ATIME | FUSE_SET_ATTR_MTIME))
+	{
+		uint32_t currentTime = static_cast<uint32_t>(time(nullptr));
+		bool modifyAtime = (to_set & FUSE_SET_ATTR_ATIME) != 0;
+		bool modifyMtime = (to_set & FUSE_SET_ATTR_MTIME) != 0;
+		uint32_t atime = (to_set & FUSE_SET_ATTR_ATIME_NOW) ? currentTime : static_cast<uint32_t>(attr->st_atim.tv_sec);
+		uint32_t mtime = (to_set & FUSE_SET_ATTR_MTIME_NOW) ? currentTime : static_cast<uint32_t>(attr->st_mtim.tv_sec);
+		err = fs.utimens(ino, atime, mtime, modifyAtime, modifyMtime);
+		if (err != SUCCESS)
+		{
+			replyError(req, err);
+			return;
+		}
+	}
+	struct stat st = fs.getFileStat(ino, err);
+	if (err != SUCCESS)
+	{
+		replyError(req, err);
+		return;
+	}
+	fuse_reply_attr(req, &st, g_AttrTimeout);
+}
+
+static void ll_readlink(fuse_req_t req, fuse_ino_t ino)
+{
+	Logger::log(std::string("readlink called for inode: ") + std::to_string(ino), LOG_DEBUG);
+	ErrorCode err;
+	std::string linkTarget = g_FileSystem.readLink(ino, err);
+	if (err != SUCCESS)
+	{
+		replyError(req, err);
+		return;
+	}
+	fuse_reply_readlink(req, linkTarget.c_str());
+}
+
+static void ll_mknod(fuse_req_t req, fuse_ino_t parent, const char *name, mode_t mode, dev_t rdev)
+{
+	Logger::log(std::string("mknod called for parent: ") + std::to_string(parent) + ", name: " + name + ", mode: " + std::to_string(mode), LOG_DEBUG);
+	if (!S_ISREG(mode))
+	{
+		fuse_reply_err(req, ENOSYS);
+		return;
+	}
+	uint16_t uid, gid;
+	if (!getRequestOwner(req, uid, gid))
+	{
+		fuse_reply_err(req, EOVERFLOW);
+		return;
+	}
+	ErrorCode err;
+	Ino newInodeNumber = g_FileSystem.createFile(parent, name, mode, uid, gid, err);
+	if (err != SUCCESS)
+	{
+		replyError(req, err);
+		return;
+	}
+	replyEntry(req, newInodeNumber);
+}
+
+static void ll_mkdir(fuse_req_t req, fuse_ino_t parent, const char *name, mode_t mode)
+{
+	Logger::log(std::string("mkdir called for parent: ") + std::to_string(parent) + ", name: " + name, LOG_DEBUG);
+	uint16_t uid, gid;
+	if (!getRequestOwner(req, uid, gid))
+	{
+		fuse_reply_err(req, EOVERFLOW);
+		return;
+	}
+	ErrorCode err;
+	Ino dirInodeNumber = g_FileSystem.mkdir(parent, name, mode, uid, gid, err);
+	if (err != SUCCESS)
+	{
+		replyError(req, err);
+		return;
+	}
+	replyEntry(req, dirInodeNumber);
+}
+
+static void ll_unlink(fuse_req_t req, fuse_ino_t parent, const char *name)
+{
+	Logger::log(std::string("unlink called for parent: ") + std::to_string(parent) + ", name: " + name, LOG_DEBUG);
+	ErrorCode err = g_FileSystem.unlinkFile(parent, name);
+	fuse_reply_err(req, -errorCodeToInt(err));
+}
+
+static void ll_rmdir(fuse_req_t req, fuse_ino_t parent, const char *name)
+{
+	Logger::log(std::string("rmdir called for parent: ") + std::to_string(parent) + ", name: " + name, LOG_DEBUG);
+	ErrorCode err = g_FileSystem.rmdir(parent, name);
+	fuse_reply_err(req, -errorCodeToInt(err));
+}
+
+static void ll_symlink(fuse_req_t req, const char *link, fuse_ino_t parent, const char *name)
+{
+	Logger::log(std::string("symlink called with target: ") + link + " for parent: " + std::to_string(parent) + ", name: " + name, LOG_DEBUG);
+	uint16_t uid, gid;
+	if (!getRequestOwner(req, uid, gid))
+	{
+		fuse_reply_err(req, EOVERFLOW);
+		return;
+	}
+	ErrorCode err;
+	Ino symlinkInodeNumber = g_FileSystem.createSymlink(link, parent, name, 0777, uid, gid, err);
+	if (err != SUCCESS)
+	{
+		replyError(req, err);
+		return;
+	}
+	replyEntry(req, symlinkInodeNumber);
+}
+
+static void ll_rename(fuse_req_t req, fuse_ino_t parent, const char *name, fuse_ino_t newparent, const char *newname, unsigned int flags)
+{
+	Logger::log(std::string("rename called from: ") + std::to_string(parent) + "/" + name + " to: " + std::to_string(newparent) + "/" + newname, LOG_DEBUG);
+	if (flags & (RENAME_EXCHANGE | RENAME_WHITEOUT))
+	{
+		fuse_reply_err(req, EINVAL);
+		return;
+	}
+	ErrorCode err = g_FileSystem.renameFile(parent, name, newparent, newname, (flags & RENAME_NOREPLACE) != 0);
+	fuse_reply_err(req, -errorCodeToInt(err));
+}
+
+static void ll_link(fuse_req_t req, fuse_ino_t ino, fuse_ino_t newparent, const char *newname)
+{
+	Logger::log(std::string("link called for inode: ") + std::to_string(ino) + " to: " + std::to_string(newparent) + "/" + newname, LOG_DEBUG);
+	ErrorCode err = g_FileSystem.linkFile(ino, newparent, newname);
+	if (err != SUCCESS)
+	{
+		replyError(req, err);
+		return;
+	}
+	replyEntry(req, ino);
+}
+
+static FileHandle *fileHandle(fuse_file_info *fi)
+{
+	return reinterpret_cast<FileHandle*>(fi->fh);
+}
+
+static void ll_open(fuse_req_t req, fuse_ino_t ino, fuse_file_info *fi)
+{
+	Logger::log(std::string("open called for inode: ") + std::to_string(ino), LOG_DEBUG);
+	ErrorCode err = g_FileSystem.openFile(ino, fi->flags);
+	if (err != SUCCESS)
+	{
+		replyError(req, err);
+		return;
+	}
+	fi->fh = reinterpret_cast<uint64_t>(new FileHandle(ino));
+	fi->keep_cache = 1;
+	fuse_reply_open(req, fi);
+}
+
+static void ll_create(fuse_req_t req, fuse_ino_t parent, const char *name, mode_t mode, fuse_file_info *fi)
+{
+	Logger::log(std::string("create called for parent: ") + std::to_string(parent) + ", name: " + name, LOG_DEBUG);
+	FS &fs = g_FileSystem;
+	uint16_t uid, gid;
+	if (!getRequestOwner(req, uid, gid))
+	{
+		fuse_reply_err(req, EOVERFLOW);
+		return;
+	}
+	ErrorCode err;
+	Ino newInodeNumber = fs.createFile(parent, name, mode, uid, gid, err);
+	if (err != SUCCESS)
+	{
+		replyError(req, err);
+		return;
+	}
+	fuse_entry_param entry;
+	if (!fillEntry(newInodeNumber, entry, err))
+	{
+		fs.forgetInode(newInodeNumber, 1);
+		replyError(req, err);
+		return;
+	}
+	err = fs.openFile(newInodeNumber, O_RDWR);
+	if (err != SUCCESS)
+	{
+		fs.forgetInode(newInodeNumber, 1);
+		replyError(req, err);
+		return;
+	}
+	fi->fh = reinterpret_cast<uint64_t>(new FileHandle(newInodeNumber));
+	fi->keep_cache = 1;
+	fuse_reply_create(req, &entry, fi);
+}
+
+static void ll_read(fuse_req_t req, fuse_ino_t ino, size_t size, off_t off, fuse_file_info *fi)
+{
+	Logger::log(std::string("read called for inode: ") + std::to_string(ino) + ", size: " + std::to_string(size) + ", offset: " + std::to_string(off), LOG_DEBUG);
+	ErrorCode err;
+	if (off > MINIX3_MAX_FILE_SIZE)
+	{
+		fuse_reply_buf(req, nullptr, 0);
+		return;
+	}
+	if (size > MINIX3_MAX_FILE_SIZE - off)
+	{
+		size = static_cast<size_t>(MINIX3_MAX_FILE_SIZE - off);
+	}
+	std::vector<uint8_t> buffer(size);
+	uint32_t bytesRead = g_FileSystem.readFile(*fileHandle(fi), buffer.data(), static_cast<uint32_t>(off), static_cast<uint32_t>(size), err);
+	if (err != SUCCESS)
+	{
+		replyError(req, err);
+		return;
+	}
+	fuse_reply_buf(req, reinterpret_cast<const char*>(buffer.data()), bytesRead);
+}
+
+static void ll_write(fuse_req_t req, fuse_ino_t ino, const char *buf, size_t size, off_t off, fuse_file_info *fi)
+{
+	Logger::log(std::string("write called for inode: ") + std::to_string(ino) + ", size: " + std::to_string(size) + ", offset: " + std::to_string(off), LOG_DEBUG);
+	ErrorCode err;
+	if (size == 0)
+	{
+		fuse_reply_write(req, 0);
+		return;
+	}
+	if (off >= MINIX3_MAX_FILE_SIZE)
+	{
+		fuse_reply_err(req, EFBIG);
+		return;
+	}
+	if (size > MINIX3_MAX_FILE_SIZE - off)
+	{
+		size = static_cast<size_t>(MINIX3_MAX_FILE_SIZE - off);
+	}
+	uint32_t bytesWritten = g_FileSystem.writeFile(fileHandle(fi)->inodeNumber, reinterpret_cast<const uint8_t*>(buf), static_cast<uint32_t>(off), static_cast<uint32_t>(size), err);
+	if (err != SUCCESS)
+	{
+		replyError(req, err);
+		return;
+	}
+	fuse_reply_write(req, bytesWritten);
+}
+
+static void ll_flush(fuse_req_t req, fuse_ino_t ino, fuse_file_info *fi)
+{
+	Logger::log(std::string("flush called for inode: ") + std::to_string(ino), LOG_DEBUG);
+	fuse_reply_err(req, 0);
+}
+
+static void ll_release(fuse_req_t req, fuse_ino_t ino, fuse_file_info *fi)
+{
+	Logger::log(std::string("release called for inode: ") + std::to_string(ino), LOG_DEBUG);
+	FileHandle *handle = fileHandle(fi);
+	ErrorCode err = g_FileSystem.closeFile(handle->inodeNumber);
+	delete handle;
+	fuse_reply_err(req, -errorCodeToInt(err));
+}
+
+static void ll_fsync(fuse_req_t req, fuse_ino_t ino, int datasync, fuse_file_info *fi)
+{
+	Logger::log(std::string("fsync called for inode: ") + std::to_string(ino), LOG_DEBUG);
+	ErrorCode err = g_FileSystem.fsync(datasync != 0);
+	fuse_reply_err(req, -errorCodeToInt(err));
+}
+
+static void ll_opendir(fuse_req_t req, fuse_ino_t ino, fuse_file_info *fi)
+{
+	Logger::log(std::string("opendir called for inode: ") + std::to_string(ino), LOG_DEBUG);
+	ErrorCode err;
+	struct stat st = g_FileSystem.getFileStat(ino, err);
+	if (err != SUCCESS)
+	{
+		replyError(req, err);
+		return;
+	}
+	if (!S_ISDIR(st.st_mode))
+	{
+		fuse_reply_err(req, ENOTDIR);
+		return;
+	}
+	fi->fh = ino;
+	fuse_reply_open(req, fi);
+}
+
+static void readDirectory(fuse_req_t req, size_t size, off_t off, fuse_file_info *fi, bool plus)
+{
+	FS &fs = g_FileSystem;
+	ErrorCode err;
+	Ino inodeNumber = fi->fh;
+	uint32_t totalEntries = fs.getDirectorySize(inodeNumber, err);
+	if (err != SUCCESS)
+	{
+		replyError(req, err);
+		return;
+	}
+	std::vector<char> buffer(size);
+	size_t used = 0;
+	bool full = false;
+	for (uint32_t chunkStart = off; !full && chunkStart < totalEntries; chunkStart += DIR_ITERATE_CHUNK_ENTRIES)
+	{
+		std::vector<DirEntry> entries = fs.listDir(inodeNumber, chunkStart, DIR_ITERATE_CHUNK_ENTRIES, err, plus);
+		if (err != SUCCESS)
+		{
+			if (used == 0)
+			{
+				replyError(req, err);
+				return;
+			}
+			break;
+		}
+		for (const DirEntry &entry : entries)
+		{
+			std::string name = char60ToString(entry.raw.d_name);
+			bool retained = plus && name != "." && name != "..";
+			if (full)
+			{
+				if (retained)
+				{
+					fs.forgetInode(entry.raw.d_inode, 1);
+				}
+				continue;
+			}
+			size_t entrySize;
+			if (plus)
+			{
+				fuse_entry_param param;
+				std::memset(&param, 0, sizeof(fuse_entry_param));
+				param.ino = entry.st.st_ino;
+				param.attr = entry.st;
+				param.attr_timeout = g_AttrTimeout;
+				param.entry_timeout = g_EntryTimeout;
+				entrySize = fuse_add_direntry_plus(req, buffer.data() + used, size - used, name.c_str(), &param, entry.index + 1);
+			}
+			else
+			{
+				entrySize = fuse_add_direntry(req, buffer.data() + used, size - used, name.c_str(), &entry.st, entry.index + 1);
+			}
+			if (entrySize > size - used)
+			{
+				full = true;
+				if (retained)
+				{
+					fs.forgetInode(entry.raw.d_inode, 1);
+				}
+				continue;
+			}
+			used += entrySize;
+		}
+	}
+	fuse_reply_buf(req, buffer.data(), used);
+}
+
+static void ll_readdir(fuse_req_t req, fuse_ino_t ino, size_t size, off_t off, fuse_file_info *fi)
+{
+	Logger::log(std::string("readdir called for inode: ") + std::to_string(ino), LOG_DEBUG);
+	readDirectory(req, size, off, fi, false);
+}
+
+static void ll_readdirplus(fuse_req_t req, fuse_ino_t ino, size_t size, off_t off, fuse_file_info *fi)
+{
+	Logger::log(std::string("readdirplus called for inode: ") + std::to_string(ino), LOG_DEBUG);
+	readDirectory(req, size, off, fi, true);
+}
+
+static void ll_releasedir(fuse_req_t req, fuse_ino_t ino, fuse_file_info *fi)
+{
+	Logger::log(std::string("releasedir called for inode: ") + std::to_string(ino), LOG_DEBUG);
+	fuse_reply_err(req, 0);
+}
+
+static void ll_fsyncdir(fuse_req_t req, fuse_ino_t ino, int datasync, fuse_file_info *fi)
+{
+	Logger::log(std::string("fsyncdir called for inode: ") + std::to_string(ino), LOG_DEBUG);
+	fuse_reply_err(req, 0);
+}
+
+static void ll_statfs(fuse_req_t req, fuse_ino_t ino)
+{
+	Logger::log(std::string("statfs called for inode: ") + std::to_string(ino), LOG_DEBUG);
+	ErrorCode err;
+	struct statvfs fsStat = g_FileSystem.getFSStat(err);
+	if (err != SUCCESS)
+	{
+		replyError(req, err);
+		return;
+	}
+	fuse_reply_statfs(req, &fsStat);
+}
+
+static struct fuse_lowlevel_ops makeLowLevelOperations()
+{
+	struct fuse_lowlevel_ops ops = {};
+	ops.init = ll_init;
+	ops.destroy = ll_destroy;
+	ops.lookup = ll_lookup;
+	ops.forget = ll_forget;
+	ops.forget_multi = ll_forget_multi;
+	ops.getattr = ll_getattr;
+	ops.setattr = ll_setattr;
+	ops.readlink = ll_readlink;
+	ops.mknod = ll_mknod;
+	ops.mkdir = ll_mkdir;
+	ops.unlink = ll_unlink;
+	ops.rmdir = ll_rmdir;
+	ops.symlink = ll_symlink;
+	ops.rename = ll_rename;
+	ops.link = ll_link;
+	ops.open = ll_open;
+	ops.create = ll_create;
+	ops.read = ll_read;
+	ops.write = ll_write;
+	ops.flush = ll_flush;
+	ops.release = ll_release;
+	ops.fsync = ll_fsync;
+	ops.opendir = ll_opendir;
+	ops.readdir = ll_readdir;
+	ops.readdirplus = ll_readdirplus;
+	ops.releasedir = ll_releasedir;
+	ops.fsyncdir = ll_fsyncdir;
+	ops.statfs = ll_statfs;
+	return ops;
+}
+
+struct MountOptions
+{
+	char *devicePath = nullptr;
+	unsigned int cacheBlocks = BLOCK_CACHE_DEFAULT_BLOCKS;
+	bool ioUring = false;
+	bool directIO = false;
+	bool mmap = false;
+	unsigned int readaheadZones = READAHEAD_DEFAULT_MAX_ZONES;
+	bool orderedData = false;
+	char *journalPath = nullptr;
+	double entryTimeout = FUSE_ENTRY_TIMEOUT_SECONDS;
+	double attrTimeout = FUSE_ATTR_TIMEOUT_SECONDS;
+	bool showHelp = false;
+};
+
+#define OPTION(t, p) { t, offsetof(MountOptions, p), 1 }
+
+static const struct fuse_opt fs_opts[] =
+{
+	OPTION("--device=%s", devicePath),
+	OPTION("--cache-blocks=%u", cacheBlocks),
+	OPTION("--io-uring", ioUring),
+	OPTION("--direct-io", directIO),
+	OPTION("--mmap", mmap),
+	OPTION("--readahead-zones=%u", readaheadZones),
+	OPTION("--ordered-data", orderedData),
+	OPTION("--journal=%s", journalPath),
+	OPTION("entry_timeout=%lf", entryTimeout),
+	OPTION("attr_timeout=%lf", attrTimeout),
+	OPTION("-h", showHelp),
+	OPTION("--help", showHelp),
+	FUSE_OPT_END
+};
+
+static void showHelp()
+{
+	printf("Usage: minixfs-fuse-ll --device=<device_path> [options] <mountpoint>\n");
+	printf("Options:\n");
+	printf("    --cache-blocks=<n>    number of blocks kept in the buffer cache, 0 disables it (default: %d)\n", BLOCK_CACHE_DEFAULT_BLOCKS);
+	printf("    --io-uring            batch multi-zone reads through io_uring\n");
+	printf("    --direct-io           open the device with O_DIRECT and rely on the buffer cache only\n");
+	printf("    --mmap                map an image file into memory instead of using the buffer cache\n");
+	printf("    --readahead-zones=<n> largest sequential readahead window in zones, 0 disables it (default: %d)\n", READAHEAD_DEFAULT_MAX_ZONES);
+	printf("    --ordered-data        write data for newly allocated zones in place before committing metadata\n");
+	printf("    --journal=<path>      log committed transactions to a write-ahead journal file and replay it at mount\n");
+	printf("    -o entry_timeout=<s>  seconds the kernel caches name lookups (default: %d)\n", FUSE_ENTRY_TIMEOUT_SECONDS);
+	printf("    -o attr_timeout=<s>   seconds the kernel caches attributes (default: %d)\n", FUSE_ATTR_TIMEOUT_SECONDS);
+	fuse_cmdline_help();
+	fuse_lowlevel_help();
+}
+
+int main(int argc, char **argv)
+{
+	Logger::log("Starting filesystem", LOG_INFO);
+	FS &fs = g_FileSystem;
+	MountOptions options;
+	struct fuse_args args = FUSE_ARGS_INIT(argc, argv);
+	if (fuse_opt_parse(&args, &options, fs_opts, nullptr) == -1)
+	{
+		fuse_opt_free_args(&args);
+		return 1;
+	}
+	struct fuse_cmdline_opts cmdlineOptions;
+	if (fuse_parse_cmdline(&args, &cmdlineOptions) != 0)
+	{
+		fuse_opt_free_args(&args);
+		return 1;
+	}
+	if (options.showHelp || cmdlineOptions.show_help || options.devicePath == nullptr || cmdlineOptions.mountpoint == nullptr)
+	{
+		showHelp();
+		free(cmdlineOptions.mountpoint);
+		fuse_opt_free_args(&args);
+		return 0;
+	}
+	g_EntryTimeout = options.entryTimeout;
+	g_AttrTimeout = options.attrTimeout;
+	fs.setDevicePath(options.devicePath);
+	fs.setCacheCapacity(options.cacheBlocks);
+	fs.setIoUring(options.ioUring);
+	fs.setDirectIO(options.directIO);
+	fs.setMmap(options.mmap);
+	fs.setReadaheadZones(options.readaheadZones);
+	fs.setOrderedData(options.orderedData);
+	if (options.journalPath != nullptr)
+	{
+		fs.setJournalPath(options.journalPath);
+	}
+	ErrorCode err = fs.mount();
+	if (err != SUCCESS)
+	{
+		fprintf(stderr, "Failed to mount filesystem. Error code: %d\n", err);
+		free(cmdlineOptions.mountpoint);
+		fuse_opt_free_args(&args);
+		return 1;
+	}
+	if (options.ioUring && !fs.isIoUringEnabled())
+	{
+		Logger::log("io_uring is unavailable, falling back to pread", LOG_INFO);
+	}
+	if (options.directIO && !fs.isDirectIOEnabled())
+	{
+		Logger::log("O_DIRECT is unavailable, falling back to buffered I/O", LOG_INFO);
+	}
+	if (options.mmap && !fs.isMmapEnabled())
+	{
+		Logger::log("the device is not a mappable image file, falling back to the buffer cache", LOG_INFO);
+	}
+	struct fuse_lowlevel_ops fs_oper = makeLowLevelOperations();
+	struct fuse_session *session = fuse_session_new(&args, &fs_oper, sizeof(fs_oper), nullptr);
+	if (session == nullptr)
+	{
+		fs.unmount();
+		free(cmdlineOptions.mountpoint);
+		fuse_opt_free_args(&args);
+		return 1;
+	}
+	int ret = 1;
+	if (fuse_set_signal_handlers(session) == 0)
+	{
+		if (fuse_session_mount(session, cmdlineOptions.mountpoint) == 0)
+		{
+			fuse_daemonize(cmdlineOptions.foreground);
+			if (cmdlineOptions.singlethread)
+			{
+				ret = fuse_session_loop(session);
+			}
+			else
+			{
+				struct fuse_loop_config config;
+				config.clone_fd = cmdlineOptions.clone_fd;
+				config.max_idle_threads = cmdlineOptions.max_idle_threads;
+				ret = fuse_session_loop_mt(session, &config);
+			}
+			fuse_session_unmount(session);
+		}
+		fuse_remove_signal_handlers(session);
+	}
+	fuse_session_destroy(session);
+	free(cmdlineOptions.mountpoint);
+	fuse_opt_free_args(&args);
+	return ret != 0 ? 1 : 0;
+}
@@ -14,6 +14,8 @@ static void *fs_init(fuse_conn_info *conn, fuse_config *cfg)
 {
 	cfg->kernel_cache = 1;
 	cfg->use_ino = 1;
+	conn->want |= conn->capable & FUSE_CAP_READDIRPLUS;
+	conn->want |= conn->capable & FUSE_CAP_PARALLEL_DIROPS;
 	Logger::log("Filesystem initialized", LOG_INFO);
 	return nullptr;
 }
@@ -87,26 +89,22 @@ static int fs_readdir(const char *path, void *buf, fuse_fill_dir_t filler, off_t
 	{
 		return 0;
 	}
-	while (offset < totalEntries)
+	fuse_fill_dir_flags fillFlags = (flags & FUSE_READDIR_PLUS) ? FUSE_FILL_DIR_PLUS : static_cast<fuse_fill_dir_flags>(0);
+	for (uint32_t chunkStart = offset; chunkStart < totalEntries; chunkStart += DIR_ITERATE_CHUNK_ENTRIES)
 	{
-		std::vector<DirEntry> entries = fs.listDir(inodeNumber, offset, 1, err);
+		std::vector<DirEntry> entries = fs.listDir(inodeNumber, chunkStart, DIR_ITERATE_CHUNK_ENTRIES, err);
 		if (err != SUCCESS)
 		{
 			return errorCodeToInt(err);
 		}
-		if (entries.empty())
+		for (const DirEntry &entry : entries)
 		{
-			offset += 1;
-			continue;
-		}
-		auto &entry = entries[0];
-		struct stat st = entry.st;
-		std::string name = char60ToString(entry.raw.d_name);
-		if (filler(buf, name.c_str(), &st, offset + 1, static_cast<fuse_fill_dir_flags>(0)) != 0)
-		{
-			return 0;
+			std::string name = char60ToString(entry.raw.d_name);
+			if (filler(buf, name.c_str(), &entry.st, entry.index + 1, fillFlags) != 0)
+			{
+				return 0;
+			}
 		}
-		offset += 1;
 	}
 	return 0;
 }
@@ -123,6 +121,11 @@ static int fs_fsyncdir(const char *path, int isdatasync, fuse_file_info *fi)
 	return 0;
 }
 
+static FileHandle *fileHandle(fuse_file_info *fi)
+{
+	return reinterpret_cast<FileHandle*>(fi->fh);
+}
+
 static int fs_open(const char *path, fuse_file_info *fi)
 {
 	Logger::log(std::string("open called for path: ") + path, LOG_DEBUG);
@@ -132,14 +135,16 @@ static int fs_open(const char *path, fuse_file_info *fi)
 	{
 		return errorCodeToInt(err);
 	}
-	fi->fh = inodeNumber;
+	fi->fh = reinterpret_cast<uint64_t>(new FileHandle(inodeNumber));
 	return 0;
 }
 
 static int fs_release(const char *path, fuse_file_info *fi)
 {
 	Logger::log(std::string("release called for path: ") + path, LOG_DEBUG);
-	ErrorCode err = g_FileSystem.closeFile(fi->fh);
+	FileHandle *handle = fileHandle(fi);
+	ErrorCode err = g_FileSystem.closeFile(handle->inodeNumber);
+	delete handle;
 	if (err != SUCCESS)
 	{
 		return errorCodeToInt(err);
@@ -171,7 +176,7 @@ static int fs_read(const char *path, char *buf, size_t size, off_t offset, fuse_
 	{
 		size = static_cast<size_t>(MINIX3_MAX_FILE_SIZE - offset);
 	}
-	uint32_t bytesRead = fs.readFile(fi->fh, reinterpret_cast<uint8_t*>(buf), static_cast<uint32_t>(offset), static_cast<uint32_t>(size), err);
+	uint32_t bytesRead = fs.readFile(*fileHandle(fi), reinterpret_cast<uint8_t*>(buf), static_cast<uint32_t>(offset), static_cast<uint32_t>(size), err);
 	if (err != SUCCESS)
 	{
 		return errorCodeToInt(err);
@@ -196,7 +201,7 @@ static int fs_write(const char *path, const char *buf, size_t size, off_t offset
 	{
 		size = static_cast<size_t>(MINIX3_MAX_FILE_SIZE - offset);
 	}
-	uint32_t bytesWritten = fs.writeFile(fi->fh, reinterpret_cast<const uint8_t*>(buf), static_cast<uint32_t>(offset), static_cast<uint32_t>(size), err);
+	uint32_t bytesWritten = fs.writeFile(fileHandle(fi)->inodeNumber, reinterpret_cast<const uint8_t*>(buf), static_cast<uint32_t>(offset), static_cast<uint32_t>(size), err);
 	if (err != SUCCESS)
 	{
 		return errorCodeToInt(err);
@@ -226,7 +231,7 @@ static int fs_create(const char *path, mode_t mode, fuse_file_info *fi)
 	{
 		return errorCodeToInt(err);
 	}
-	fi->fh = newInodeNumber;
+	fi->fh = reinterpret_cast<uint64_t>(new FileHandle(newInodeNumber));
 	return 0;
 }
 
@@ -256,7 +261,7 @@ static int fs_truncate(const char *path, off_t size, fuse_file_info *fi)
 	}
 	if (fi != nullptr)
 	{
-		ErrorCode err = fs.truncateFile(fi->fh, static_cast<uint32_t>(size));
+		ErrorCode err = fs.truncateFile(fileHandle(fi)->inodeNumber, static_cast<uint32_t>(size));
 		if (err != SUCCESS)
 		{
 			return errorCodeToInt(err);
@@ -498,6 +503,13 @@ static struct fuse_operations makeFsOperations()
 struct MountOptions
 {
 	char *devicePath = nullptr;
+	unsigned int cacheBlocks = BLOCK_CACHE_DEFAULT_BLOCKS;
+	bool ioUring = false;
+	bool directIO = false;
+	bool mmap = false;
+	unsigned int readaheadZones = READAHEAD_DEFAULT_MAX_ZONES;
+	bool orderedData = false;
+	char *journalPath = nullptr;
 	bool showHelp = false;
 };
 
@@ -506,6 +518,13 @@ struct MountOptions
 static const struct fuse_opt fs_opts[] = 
 {
 	OPTION("--device=%s", devicePath),
+	OPTION("--cache-blocks=%u", cacheBlocks),
+	OPTION("--io-uring", ioUring),
+	OPTION("--direct-io", directIO),
+	OPTION("--mmap", mmap),
+	OPTION("--readahead-zones=%u", readaheadZones),
+	OPTION("--ordered-data", orderedData),
+	OPTION("--journal=%s", journalPath),
 	OPTION("-h", showHelp),
 	OPTION("--help", showHelp),
 	FUSE_OPT_END
@@ -513,7 +532,17 @@ static const struct fuse_opt fs_opts[] =
 
 static void showHelp()
 {
-	printf("Usage: minixfs-fuse --device=<device_path> [FUSE options]\n");
+	printf("Usage: minixfs-fuse --device=<device_path> [options] [FUSE options]\n");
+	printf("Options:\n");
+	printf("    --cache-blocks=<n>    number of blocks kept in the buffer cache, 0 disables it (default: %d)\n", BLOCK_CACHE_DEFAULT_BLOCKS);
+	printf("    --io-uring            batch multi-zone reads through io_uring\n");
+	printf("    --direct-io           open the device with O_DIRECT and rely on the buffer cache only\n");
+	printf("    --mmap                map an image file into memory instead of using the buffer cache\n");
+	printf("    --readahead-zones=<n> largest sequential readahead window in zones, 0 disables it (default: %d)\n", READAHEAD_DEFAULT_MAX_ZONES);
+	printf("    --ordered-data        write data for newly allocated zones in place before committing metadata\n");
+	printf("    --journal=<path>      log committed transactions to a write-ahead journal file and replay it at mount\n");
+	printf("    -o entry_timeout=<s>  seconds the kernel caches name lookups (default: 1)\n");
+	printf("    -o attr_timeout=<s>   seconds the kernel caches attributes (default: 1); other names of a hard-linked file may show stale attributes for this long\n");
 }
 
 int main(int argc, char **argv)
@@ -534,6 +563,16 @@ int main(int argc, char **argv)
 		return 0;
 	}
 	fs.setDevicePath(options.devicePath);
+	fs.setCacheCapacity(options.cacheBlocks);
+	fs.setIoUring(options.ioUring);
+	fs.setDirectIO(options.directIO);
+	fs.setMmap(options.mmap);
+	fs.setReadaheadZones(options.readaheadZones);
+	fs.setOrderedData(options.orderedData);
+	if (options.journalPath != nullptr)
+	{
+		fs.setJournalPath(options.journalPath);
+	}
 	ErrorCode err = fs.mount();
 	if (err != SUCCESS)
 	{
@@ -541,7 +580,18 @@ int main(int argc, char **argv)
 		fuse_opt_free_args(&args);
 		return 1;
 	}
-	fuse_opt_add_arg(&args, "-s");
+	if (options.ioUring && !fs.isIoUringEnabled())
+	{
+		Logger::log("io_uring is unavailable, falling back to pread", LOG_INFO);
+	}
+	if (options.directIO && !fs.isDirectIOEnabled())
+	{
+		Logger::log("O_DIRECT is unavailable, falling back to buffered I/O", LOG_INFO);
+	}
+	if (options.mmap && !fs.isMmapEnabled())
+	{
+		Logger::log("the device is not a mappable image file, falling back to the buffer cache", LOG_INFO);
+	}
 	struct fuse_operations fs_oper = makeFsOperations();
 	int ret = fuse_main(args.argc, args.argv, &fs_oper, nullptr);
 	fuse_opt_free_args(&args);
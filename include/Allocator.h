@@ -1,12 +1,21 @@
 #pragma once
 
 #include <cstdint>
-#include <map>
 #include <set>
+#include <unordered_map>
+#include <vector>
+#include <mutex>
 #include "BlockDevice.h"
 #include "Layout.h"
 #include "Errors.h"
 
+struct FreeRunSummary
+{
+	uint32_t prefix;
+	uint32_t suffix;
+	uint32_t longest;
+};
+
 struct Allocator
 {
 	BlockDevice *blockDevice = nullptr;
@@ -18,20 +27,59 @@ struct Allocator
 	uint32_t bitsPerBlock;
 	uint32_t lstAllocated;
 	bool isInTransaction = false;
-	uint8_t *bmapCache = nullptr;
-	std::map<uint32_t, uint8_t> transactionDirtyBlocks;
+	uint32_t totalWords;
+	uint64_t *bmapCache = nullptr;
+	uint32_t allocatedCount = 0;
+	int32_t transactionCountDelta = 0;
+	uint32_t groupWords = 0;
+	std::vector<uint32_t> groupFreeCounts;
+	std::unordered_map<uint32_t, int32_t> transactionGroupDeltas;
+	std::unordered_map<uint32_t, uint64_t> transactionDirtyWords;
+	std::vector<uint64_t> transactionWordMask;
+	uint32_t chunkCount = 0;
+	uint32_t regionCount = 0;
+	std::vector<uint64_t> freeWordBits;
+	std::vector<uint64_t> freeChunkBits;
+	std::vector<uint64_t> staleChunkBits;
+	std::vector<uint64_t> staleRegionBits;
+	std::vector<FreeRunSummary> chunkRuns;
+	std::vector<FreeRunSummary> regionRuns;
 	std::set<Bno> dirtyBlockSet;
+	mutable std::mutex mutex;
 	bool setBit(uint32_t idx, bool value);
+	uint64_t wordAt(uint32_t word) const;
+	uint64_t usableBits(uint32_t word) const;
+	uint64_t freeBitsAt(uint32_t word) const;
+	void buildSummaries();
+	static FreeRunSummary wordRuns(uint64_t freeBits);
+	static FreeRunSummary combineRuns(const FreeRunSummary &left, uint32_t leftBits, const FreeRunSummary &right, uint32_t rightBits);
+	void buildChunk(uint32_t chunk);
+	void buildRegion(uint32_t region);
+	void noteWordChanged(uint32_t word);
+	const FreeRunSummary &chunkSummary(uint32_t chunk);
+	const FreeRunSummary &regionSummary(uint32_t region);
+	bool nextFreeWord(uint32_t firstWord, uint32_t endWord, uint32_t &outWord) const;
+	bool findFree(uint32_t firstWord, uint32_t endWord, uint64_t firstMask, uint32_t &outBit) const;
+	uint32_t freeRunLength(uint32_t bit, uint32_t limit) const;
+	bool runMayStart(const FreeRunSummary &summary, uint64_t nextBit, uint32_t count) const;
+	bool findFreeRun(uint32_t startBit, uint32_t stopBit, uint32_t count, uint32_t &outBit);
+	uint32_t longestFreeRun();
+	uint32_t allocateNear(uint32_t startBit, ErrorCode &outError);
+	uint32_t groupFree(uint32_t group) const;
 
 	Allocator();
 	~Allocator();
 	void setBlockDevice(BlockDevice &bd);
+	void setGroupBits(uint32_t groupBits);
 	ErrorCode init(uint32_t bmapStartBlock, uint32_t totalBmaps, uint32_t firstFreeBmap, uint32_t blockSize);
 	ErrorCode sync();
-	uint32_t allocateBmap(ErrorCode &outError);
+	uint32_t allocateBmap(uint32_t hint, ErrorCode &outError);
+	uint32_t allocateSpread(uint32_t hint, ErrorCode &outError);
+	uint32_t allocateRun(uint32_t count, uint32_t hint, uint32_t &outCount, ErrorCode &outError);
 	ErrorCode freeBmap(uint32_t idx);
 	ErrorCode beginTransaction();
 	ErrorCode revertTransaction();
 	ErrorCode commitTransaction();
 	uint32_t getAllocatedCount() const;
+	bool isCommittedFree(uint32_t idx) const;
 };
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <sys/uio.h>
+#include "Errors.h"
+#include "IoUring.h"
+
+class BlockBackend
+{
+public:
+	virtual ~BlockBackend() = default;
+	virtual ErrorCode open() = 0;
+	virtual ErrorCode close() = 0;
+	virtual ErrorCode read(uint64_t offset, void* buffer, size_t size) = 0;
+	virtual ErrorCode write(uint64_t offset, const void* buffer, size_t size) = 0;
+	virtual ErrorCode readVector(uint64_t offset, const iovec *vectors, size_t count, size_t size) = 0;
+	virtual ErrorCode writeVector(uint64_t offset, const iovec *vectors, size_t count, size_t size) = 0;
+	virtual ErrorCode readBatch(std::vector<IoUringRequest> &requests) = 0;
+	virtual uint8_t *memory(uint64_t offset, size_t size) = 0;
+	virtual bool isMemoryBacked() const = 0;
+	virtual ErrorCode sync(bool dataOnly) = 0;
+};
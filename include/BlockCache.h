@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "Errors.h"
+#include "Type.h"
+
+class BlockDevice;
+
+struct BlockCacheSlot
+{
+	Bno blockNumber;
+	bool dirty;
+	uint32_t pinCount;
+	bool detached;
+	std::list<uint32_t>::iterator lruPosition;
+};
+
+struct BlockCacheShard
+{
+	std::mutex mutex;
+	std::unordered_map<Bno, uint32_t> slotOfBlock;
+	std::list<uint32_t> lru;
+	std::vector<uint32_t> freeSlots;
+};
+
+class BlockCache
+{
+private:
+	BlockDevice *blockDevice;
+	uint32_t blockSize;
+	uint32_t capacity;
+	uint32_t shardCount;
+	uint8_t *pool;
+	std::vector<BlockCacheSlot> slots;
+	std::unique_ptr<BlockCacheShard[]> shards;
+	BlockCacheShard &shardOf(Bno blockNumber);
+	uint8_t *slotData(uint32_t slot);
+	ErrorCode takeSlot(BlockCacheShard &shard, uint32_t &outSlot);
+public:
+	BlockCache();
+	~BlockCache();
+	void setBlockDevice(BlockDevice &blockDevice);
+	ErrorCode init(uint32_t capacity, uint32_t blockSize);
+	void release();
+	bool isEnabled() const;
+	uint32_t getCapacity() const;
+	bool read(Bno blockNumber, void *buffer);
+	const uint8_t *pin(Bno blockNumber, uint32_t &outSlot);
+	void unpin(uint32_t slot);
+	ErrorCode write(Bno blockNumber, const void *buffer, bool dirty);
+	void updateIfPresent(Bno blockNumber, const void *buffer);
+	void invalidate(Bno blockNumber);
+	ErrorCode flush();
+};
@@ -3,34 +3,88 @@
 #include <string>
 #include <cstdint>
 #include <vector>
-#include <map>
+#include <memory>
+#include <atomic>
+#include <thread>
 #include "Errors.h"
 #include "Type.h"
+#include "BlockCache.h"
+#include "IoUring.h"
+#include "BlockBackend.h"
+#include "FileBackend.h"
+#include "TransactionWriteSet.h"
+#include "Journal.h"
+
+struct ZoneRun
+{
+	uint64_t offset;
+	uint8_t *buffer;
+	uint32_t size;
+};
+
+struct ZoneWriteRun
+{
+	uint64_t offset;
+	const uint8_t *buffer;
+	uint32_t size;
+};
 
 class BlockDevice
 {
 private:
-	std::string devicePath;
-	int fd;
+	std::unique_ptr<BlockBackend> backend;
+	FileBackend *fileBackend;
 	uint16_t blockSize;
 	uint32_t zoneSize;
-	bool isInTransaction;
-	std::map<Bno, std::vector<uint8_t>> transactionWrites;
-	const int MAX_READ_RETRIES = 3;
+	std::atomic<bool> isInTransaction;
+	std::atomic<std::thread::id> transactionOwner;
+	TransactionWriteSet transactionWrites;
+	uint32_t cacheCapacity;
+	BlockCache cache;
+	Journal journal;
+	ErrorCode readRaw(uint64_t offset, void* buffer, size_t size);
+	ErrorCode writeRaw(uint64_t offset, const void* buffer, size_t size);
+	ErrorCode readVector(uint64_t offset, const iovec *vectors, size_t count, size_t size);
+	ErrorCode writeVector(uint64_t offset, const iovec *vectors, size_t count, size_t size);
+	ErrorCode readRawBatch(std::vector<IoUringRequest> &requests);
+	ErrorCode readRuns(const ZoneRun *runs, size_t count);
+	bool ownsTransaction() const;
+	ErrorCode flushJournal();
+	ErrorCode checkpoint();
+	friend class BlockCache;
 public:
 	BlockDevice();
 	BlockDevice(const std::string &path);
+	BlockDevice(std::unique_ptr<BlockBackend> blockBackend);
 	void setDevicePath(const std::string &path);
 	void setBlockSize(uint16_t size);
 	void setZoneSize(uint32_t size);
+	void setCacheCapacity(uint32_t blocks);
+	void setIoUring(bool enabled);
+	bool isIoUringEnabled() const;
+	void setDirectIO(bool enabled);
+	bool isDirectIOEnabled() const;
+	void setMmap(bool enabled);
+	bool isMmapEnabled() const;
+	void setJournalPath(const std::string &path);
+	bool isJournalEnabled() const;
+	uint32_t getCacheCapacity() const;
+	bool isMemoryBacked() const;
+	ErrorCode initCache();
 	ErrorCode open();
 	ErrorCode close();
 	ErrorCode readBytes(uint64_t offset, void* buffer, size_t size);
 	ErrorCode readBlock(uint32_t blockNumber, void* buffer);
+	const uint8_t *peekBlock(uint32_t blockNumber);
+	const uint8_t *pinBlock(uint32_t blockNumber, uint32_t &outPin);
+	void unpinBlock(uint32_t pin);
 	ErrorCode readZone(uint32_t zoneNumber, void* buffer);
+	ErrorCode readRuns(const std::vector<ZoneRun> &runs);
 	ErrorCode writeBytes(uint64_t offset, const void* buffer, size_t size);
 	ErrorCode writeBlock(uint32_t blockNumber, const void* buffer);
 	ErrorCode writeZone(uint32_t zoneNumber, const void* buffer);
+	ErrorCode writeRuns(const std::vector<ZoneWriteRun> &runs);
+	ErrorCode writeRunsInPlace(const std::vector<ZoneWriteRun> &runs);
 	ErrorCode fdatasync();
 	ErrorCode fsync();
 	ErrorCode beginTransaction();
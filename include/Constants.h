@@ -22,4 +22,35 @@
 #define MAX_PATH_DEPTH 256
 #define MINIX3_MAX_FILE_SIZE (std::numeric_limits<uint32_t>::max())
 #define ONETIME_MAX_WRITE_SIZE (1 << 26)
-#define MAX_LOG_ZONE_SIZE 7
\ No newline at end of file
+#define MAX_LOG_ZONE_SIZE 7
+#define BLOCK_CACHE_DEFAULT_BLOCKS 16384
+#define BLOCK_CACHE_SHARDS 16
+#define BLOCK_CACHE_ALIGNMENT 4096
+#define BLOCK_CACHE_FLUSH_RUN_BLOCKS 256
+#define BLOCK_CACHE_NO_PIN 0xffffffffu
+#define TRANSACTION_ARENA_CHUNK_BLOCKS 256
+#define TRANSACTION_ARENA_RETAINED_CHUNKS 16
+#define TRANSACTION_INDEX_MIN_ENTRIES 1024
+#define INODE_CACHE_DEFAULT_CAPACITY 65536
+#define DENTRY_CACHE_DEFAULT_CAPACITY 65536
+#define PATH_CACHE_DEFAULT_CAPACITY 16384
+#define DIR_INDEX_DEFAULT_CAPACITY (1 << 20)
+#define DIR_ITERATE_CHUNK_ENTRIES 256
+#define DIRECT_IO_MIN_ALIGNMENT 512
+#define DIRECT_IO_MAX_ALIGNMENT 4096
+#define DIRECT_IO_BOUNCE_BYTES (1 << 20)
+#define VECTORED_IO_MAX_SEGMENTS 1024
+#define IO_URING_QUEUE_DEPTH 64
+#define IO_URING_RINGS 4
+#define READAHEAD_MIN_ZONES 4
+#define READAHEAD_DEFAULT_MAX_ZONES 256
+#define READAHEAD_QUEUE_LIMIT 64
+#define ALLOCATE_RUN_MIN_ZONES 2
+#define ALLOCATE_INODE_GROUP_INODES 2048
+#define ALLOCATOR_CHUNK_BITS 4096
+#define ALLOCATOR_SUMMARY_PARALLEL_CHUNKS 256
+#define JOURNAL_MAGIC 0x4a4e524d
+#define JOURNAL_GROUP_COMMIT_BYTES (1 << 22)
+#define JOURNAL_CHECKPOINT_BYTES (1 << 26)
+#define FUSE_ENTRY_TIMEOUT_SECONDS 60
+#define FUSE_ATTR_TIMEOUT_SECONDS 60
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include "Type.h"
+#include "Errors.h"
+#include "Constants.h"
+
+struct DentryCacheEntry
+{
+	Ino inodeNumber;
+	uint32_t entryIndex;
+	std::list<std::pair<Ino, std::string>>::iterator lruPosition;
+};
+
+struct DentryCache
+{
+	uint32_t capacity = DENTRY_CACHE_DEFAULT_CAPACITY;
+	uint32_t size = 0;
+	bool isInTransaction = false;
+	std::mutex mutex;
+	std::unordered_map<Ino, std::unordered_map<std::string, DentryCacheEntry>> directories;
+	std::list<std::pair<Ino, std::string>> lru;
+	std::set<std::pair<Ino, std::string>> transactionDirtyNames;
+	std::unordered_set<Ino> transactionDirtyDirectories;
+	void setCapacity(uint32_t capacity);
+	bool lookup(Ino parentInodeNumber, const std::string &name, Ino &outInodeNumber, uint32_t &outEntryIndex);
+	void insert(Ino parentInodeNumber, const std::string &name, Ino inodeNumber, uint32_t entryIndex);
+	void invalidate(Ino parentInodeNumber, const std::string &name);
+	void invalidateDirectory(Ino dirInodeNumber);
+	ErrorCode beginTransaction();
+	ErrorCode revertTransaction();
+	ErrorCode commitTransaction();
+	void clear();
+	void erase(Ino parentInodeNumber, const std::string &name);
+	void eraseDirectory(Ino dirInodeNumber);
+	void evict();
+	void dropTransactionDirty();
+};
@@ -5,6 +5,8 @@
 #include "DirReader.h"
 #include "FileDeleter.h"
 #include "PathResolver.h"
+#include "DentryCache.h"
+#include "DirIndex.h"
 
 struct DirDeleter
 {
@@ -13,10 +15,14 @@ struct DirDeleter
 	DirReader *dirReader;
 	FileDeleter *fileDeleter;
 	PathResolver *pathResolver;
+	DentryCache *dentryCache;
+	DirIndex *dirIndex;
 	void setInodeReader(InodeReader &inodeReader);
 	void setInodeWriter(InodeWriter &inodeWriter);
 	void setDirReader(DirReader &dirReader);
 	void setFileDeleter(FileDeleter &fileDeleter);
 	void setPathResolver(PathResolver &pathResolver);
+	void setDentryCache(DentryCache &dentryCache);
+	void setDirIndex(DirIndex &dirIndex);
 	ErrorCode deleteDir(Ino parentInodeNumber, const std::string &dirName);
 };
\ No newline at end of file
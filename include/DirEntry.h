@@ -14,6 +14,7 @@ struct DirEntry
 {
 	DirEntryOnDisk raw;
 	struct stat st;
+	uint32_t index;
 	bool isFifo() const;
 	bool isCharacterDevice() const;
 	bool isDirectory() const;
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include "Type.h"
+#include "Errors.h"
+#include "Constants.h"
+#include "InodeReader.h"
+#include "DirReader.h"
+
+struct DirIndexEntry
+{
+	uint32_t slot;
+	Ino inodeNumber;
+};
+
+struct DirIndexDirectory
+{
+	std::unordered_map<std::string, DirIndexEntry> entryOfName;
+	std::set<uint32_t> freeSlots;
+	uint32_t slotCount;
+	std::list<Ino>::iterator lruPosition;
+};
+
+struct DirIndexTransactionDirectory
+{
+	bool replacesCommitted;
+	DirIndexDirectory directory;
+	std::set<uint32_t> usedSlots;
+};
+
+struct DirIndex
+{
+	InodeReader *inodeReader;
+	DirReader *dirReader;
+	uint32_t capacity = DIR_INDEX_DEFAULT_CAPACITY;
+	uint32_t size = 0;
+	bool isInTransaction = false;
+	std::thread::id transactionOwner;
+	std::mutex mutex;
+	std::unordered_map<Ino, DirIndexDirectory> directories;
+	std::list<Ino> lru;
+	std::unordered_map<Ino, DirIndexTransactionDirectory> transactionDirectories;
+	std::unordered_set<Ino> transactionDirtyDirectories;
+	void setInodeReader(InodeReader &inodeReader);
+	void setDirReader(DirReader &dirReader);
+	void setCapacity(uint32_t capacity);
+	bool ownsTransaction() const;
+	DirIndexDirectory *get(Ino dirInodeNumber, std::unique_lock<std::mutex> &lock, DirIndexTransactionDirectory *&outChanges, ErrorCode &outError);
+	DirIndexTransactionDirectory *getChanges(Ino dirInodeNumber);
+	bool findName(DirIndexDirectory &directory, DirIndexTransactionDirectory *changes, const std::string &name, DirIndexEntry &outEntry);
+	ErrorCode find(Ino dirInodeNumber, const std::string &name, DirIndexEntry &outEntry);
+	ErrorCode findFreeSlot(Ino dirInodeNumber, const std::string &name, bool &outFound, uint32_t &outSlot);
+	void noteWrite(Ino dirInodeNumber, uint32_t slot, Ino entryInodeNumber, const std::string &entryName);
+	void noteRemove(Ino dirInodeNumber, uint32_t slot, const std::string &oldEntryName);
+	void invalidate(Ino dirInodeNumber);
+	ErrorCode beginTransaction();
+	ErrorCode revertTransaction();
+	ErrorCode commitTransaction();
+	void clear();
+	ErrorCode build(Ino dirInodeNumber, DirIndexDirectory &directory);
+	void store(Ino dirInodeNumber, DirIndexDirectory &&directory);
+	void erase(Ino dirInodeNumber);
+	void evict();
+};
@@ -5,6 +5,7 @@
 #include "FileReader.h"
 #include "DirEntry.h"
 #include <vector>
+#include <functional>
 
 struct DirReader
 {
@@ -14,6 +15,8 @@ struct DirReader
 	void setFileReader(FileReader &fileReader);
 	ErrorCode readDirRaw(Ino dirInodeNumber, uint8_t *buffer, uint32_t sizeToRead, uint32_t offset);
 	ErrorCode readDirRaw(MinixInode3 &dirInode, uint8_t *buffer, uint32_t sizeToRead, uint32_t offset);
-	std::vector<DirEntry> readDir(Ino dirInodeNumber, uint32_t offset, uint32_t count, ErrorCode &outError, bool keepInode0Entries = false);
+	ErrorCode iterateDir(Ino dirInodeNumber, uint32_t offset, uint32_t count, const std::function<bool(uint32_t entryIndex, const DirEntryOnDisk &entry)> &visitor);
+	ErrorCode iterateDir(MinixInode3 &dirInode, uint32_t offset, uint32_t count, const std::function<bool(uint32_t entryIndex, const DirEntryOnDisk &entry)> &visitor);
+	std::vector<DirEntry> readDir(Ino dirInodeNumber, uint32_t offset, uint32_t count, ErrorCode &outError, bool keepInode0Entries = false, bool withStat = false);
 	bool isDirEmpty(Ino dirInodeNumber, ErrorCode &outError);
 };
\ No newline at end of file
@@ -4,6 +4,8 @@
 #include "DirReader.h"
 #include "InodeReader.h"
 #include "InodeWriter.h"
+#include "DentryCache.h"
+#include "DirIndex.h"
 
 struct DirWriter
 {
@@ -11,10 +13,14 @@ struct DirWriter
 	DirReader *dirReader;
 	InodeReader *inodeReader;
 	InodeWriter *inodeWriter;
+	DentryCache *dentryCache;
+	DirIndex *dirIndex;
 	void setFileWriter(FileWriter &fileWriter);
 	void setDirReader(DirReader &dirReader);
 	void setInodeReader(InodeReader &inodeReader);
 	void setInodeWriter(InodeWriter &inodeWriter);
+	void setDentryCache(DentryCache &dentryCache);
+	void setDirIndex(DirIndex &dirIndex);
 	ErrorCode addDirEntry(Ino dirInodeNumber, Ino entryInodeNumber, const std::string &entryName, uint32_t &outEntryIndex);
 	ErrorCode removeDirEntry(Ino dirInodeNumber, uint32_t entryIndex);
 	ErrorCode writeDirEntry(Ino dirInodeNumber, uint32_t entryIndex, Ino entryInodeNumber, const std::string &entryName);
@@ -6,6 +6,10 @@
 #include "Errors.h"
 #include "Layout.h"
 #include "DirEntry.h"
+#include "InodeCache.h"
+#include "DentryCache.h"
+#include "PathCache.h"
+#include "DirIndex.h"
 #include "InodeReader.h"
 #include "InodeWriter.h"
 #include "FileReader.h"
@@ -25,6 +29,8 @@
 #include "TransactionManager.h"
 #include "Allocator.h"
 #include "AttributeUpdater.h"
+#include "Readahead.h"
+#include "FileHandle.h"
 #include <string>
 #include <cstdint>
 #include <vector>
@@ -37,6 +43,10 @@ private:
 	BlockDevice g_BlockDevice;
 	MinixSuperblock3 g_Superblock;
 	Layout g_Layout;
+	InodeCache g_InodeCache;
+	DentryCache g_DentryCache;
+	PathCache g_PathCache;
+	DirIndex g_DirIndex;
 	InodeReader g_InodeReader;
 	InodeWriter g_InodeWriter;
 	FileMapper g_FileMapper;
@@ -58,16 +68,47 @@ private:
 	DirDeleter g_DirDeleter;
 	AttributeUpdater g_AttributeUpdater;
 	TransactionManager g_TransactionManager;
+	Readahead g_Readahead;
+	uint32_t readaheadZones;
+	bool orderedData;
+	uint32_t readFileLocked(Ino inodeNumber, uint8_t *buffer, uint32_t offset, uint32_t sizeToRead, ErrorCode &outError);
+	uint32_t writeFileLocked(Ino inodeNumber, const uint8_t *data, uint32_t offset, uint32_t sizeToWrite, ErrorCode &outError);
+	ErrorCode truncateFileLocked(Ino inodeNumber, uint32_t newSize);
+	uint32_t getDirectorySizeLocked(Ino inodeNumber, ErrorCode &outError);
+	std::vector<DirEntry> listDirLocked(Ino inodeNumber, ErrorCode &outError);
+	std::string readLinkLocked(Ino inodeNumber, ErrorCode &outError);
+	ErrorCode openFileLocked(Ino inodeNumber, uint32_t flags);
+	ErrorCode deleteIfOrphanLocked(Ino inodeNumber);
+	ErrorCode commitAndReapOrphansLocked();
+	ErrorCode linkFileLocked(Ino inodeNumber, Ino newParentInodeNumber, const std::string &newName);
+	Ino createFileLocked(Ino parentInodeNumber, const std::string &name, uint16_t mode, uint16_t uid, uint16_t gid, ErrorCode &outError);
+	Ino createSymlinkLocked(const std::string &target, Ino parentInodeNumber, const std::string &name, uint16_t mode, uint16_t uid, uint16_t gid, ErrorCode &outError);
+	Ino mkdirLocked(Ino parentInodeNumber, const std::string &name, uint16_t mode, uint16_t uid, uint16_t gid, ErrorCode &outError);
+	ErrorCode chmodLocked(Ino inodeNumber, uint16_t mode);
+	ErrorCode chownLocked(Ino inodeNumber, uint16_t uid, uint16_t gid, bool updateUID, bool updateGID);
+	ErrorCode utimensLocked(Ino inodeNumber, uint32_t atime, uint32_t mtime, bool updateAtime, bool updateMtime);
 public:
 	FS();
 	FS(const std::string &devicePath);
+	FS(std::unique_ptr<BlockBackend> backend);
 	void setDevicePath(const std::string &devicePath);
+	void setCacheCapacity(uint32_t blocks);
+	void setIoUring(bool enabled);
+	bool isIoUringEnabled() const;
+	void setDirectIO(bool enabled);
+	bool isDirectIOEnabled() const;
+	void setMmap(bool enabled);
+	bool isMmapEnabled() const;
+	void setReadaheadZones(uint32_t zones);
+	void setOrderedData(bool enabled);
+	void setJournalPath(const std::string &journalPath);
+	bool isJournalEnabled() const;
 	ErrorCode mount();
 	ErrorCode unmount();
 	uint16_t getBlockSize() const;
 	uint32_t getDirectorySize(Ino inodeNumber, ErrorCode &outError);
 	uint32_t getDirectorySize(const std::string &path, ErrorCode &outError);
-	std::vector<DirEntry> listDir(Ino inodeNumber, uint32_t offset, uint32_t count, ErrorCode &outError);
+	std::vector<DirEntry> listDir(Ino inodeNumber, uint32_t offset, uint32_t count, ErrorCode &outError, bool retain = false);
 	std::vector<DirEntry> listDir(Ino inodeNumber, ErrorCode &outError);
 	std::vector<DirEntry> listDir(const std::string &path, uint32_t offset, uint32_t count, ErrorCode &outError);
 	std::vector<DirEntry> listDir(const std::string &path, ErrorCode &outError);
@@ -75,22 +116,38 @@ public:
 	uint32_t writeFile(const std::string &path, const uint8_t *data, uint32_t offset, uint32_t sizeToWrite, ErrorCode &outError);
 	uint32_t readFile(Ino inodeNumber, uint8_t *buffer, uint32_t offset, uint32_t sizeToRead, ErrorCode &outError);
 	uint32_t writeFile(Ino inodeNumber, const uint8_t *data, uint32_t offset, uint32_t sizeToWrite, ErrorCode &outError);
+	uint32_t readFile(FileHandle &handle, uint8_t *buffer, uint32_t offset, uint32_t sizeToRead, ErrorCode &outError);
+	Ino lookup(Ino parentInodeNumber, const std::string &name, ErrorCode &outError);
 	struct stat getFileStat(const std::string &path, ErrorCode &outError);
+	struct stat getFileStat(Ino inodeNumber, ErrorCode &outError);
 	std::string readLink(const std::string &path, ErrorCode &outError);
+	std::string readLink(Ino inodeNumber, ErrorCode &outError);
 	struct statvfs getFSStat(ErrorCode &outError);
 	ErrorCode openFile(const std::string &path, Ino &outInodeNumber, uint32_t flags);
+	ErrorCode openFile(Ino inodeNumber, uint32_t flags);
 	ErrorCode closeFile(Ino inodeNumber);
+	ErrorCode forgetInode(Ino inodeNumber, uint64_t lookupCount);
 	ErrorCode linkFile(const std::string &existingPath, const std::string &newPath);
+	ErrorCode linkFile(Ino inodeNumber, Ino newParentInodeNumber, const std::string &newName);
 	ErrorCode unlinkFile(const std::string &path);
+	ErrorCode unlinkFile(Ino parentInodeNumber, const std::string &name);
 	Ino createFile(const std::string &path, const std::string &name, uint16_t mode, uint16_t uid, uint16_t gid, ErrorCode &outError);
+	Ino createFile(Ino parentInodeNumber, const std::string &name, uint16_t mode, uint16_t uid, uint16_t gid, ErrorCode &outError);
 	Ino createSymlink(const std::string &target, const std::string &path, uint16_t mode, uint16_t uid, uint16_t gid, ErrorCode &outError);
+	Ino createSymlink(const std::string &target, Ino parentInodeNumber, const std::string &name, uint16_t mode, uint16_t uid, uint16_t gid, ErrorCode &outError);
 	ErrorCode truncateFile(const std::string &path, uint32_t newSize);
 	ErrorCode truncateFile(Ino inodeNumber, uint32_t newSize);
 	ErrorCode renameFile(const std::string &from, const std::string &to, bool failIfDstExists);
+	ErrorCode renameFile(Ino srcParentInodeNumber, const std::string &srcName, Ino dstParentInodeNumber, const std::string &dstName, bool failIfDstExists);
 	ErrorCode mkdir(const std::string &path, uint16_t mode, uint16_t uid, uint16_t gid);
+	Ino mkdir(Ino parentInodeNumber, const std::string &name, uint16_t mode, uint16_t uid, uint16_t gid, ErrorCode &outError);
 	ErrorCode rmdir(const std::string &path);
+	ErrorCode rmdir(Ino parentInodeNumber, const std::string &name);
 	ErrorCode chmod(const std::string &path, uint16_t mode);
+	ErrorCode chmod(Ino inodeNumber, uint16_t mode);
 	ErrorCode chown(const std::string &path, uint16_t uid, uint16_t gid, bool updateUID = true, bool updateGID = true);
+	ErrorCode chown(Ino inodeNumber, uint16_t uid, uint16_t gid, bool updateUID = true, bool updateGID = true);
 	ErrorCode utimens(const std::string &path, uint32_t atime, uint32_t mtime, bool updateAtime = true, bool updateMtime = true);
+	ErrorCode utimens(Ino inodeNumber, uint32_t atime, uint32_t mtime, bool updateAtime = true, bool updateMtime = true);
 	ErrorCode fsync(bool syncDataOnly);
 };
\ No newline at end of file
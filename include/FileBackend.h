@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include "BlockBackend.h"
+
+class FileBackend: public BlockBackend
+{
+private:
+	std::string devicePath;
+	int fd;
+	bool ioUringRequested;
+	std::unique_ptr<IoUring[]> rings;
+	bool directIORequested;
+	uint32_t directIOAlignment;
+	bool mmapRequested;
+	uint8_t *mapping;
+	size_t mappingSize;
+	const int MAX_READ_RETRIES = 3;
+	size_t readFully(uint64_t offset, void* buffer, size_t size);
+	size_t writeFully(uint64_t offset, const void* buffer, size_t size);
+	bool isDirectIOAligned(uint64_t offset, const void* buffer, size_t size) const;
+	uint32_t probeDirectIOAlignment();
+	void mapDevice();
+	ErrorCode readBounced(uint64_t offset, void* buffer, size_t size);
+	ErrorCode writeBounced(uint64_t offset, const void* buffer, size_t size);
+	size_t readVectorFully(uint64_t offset, const iovec *vectors, size_t count, size_t size);
+	size_t writeVectorFully(uint64_t offset, const iovec *vectors, size_t count, size_t size);
+public:
+	FileBackend();
+	FileBackend(const std::string &path);
+	~FileBackend() override;
+	void setDevicePath(const std::string &path);
+	void setIoUring(bool enabled);
+	bool isIoUringEnabled() const;
+	void setDirectIO(bool enabled);
+	bool isDirectIOEnabled() const;
+	void setBlockSize(uint32_t size);
+	void setMmap(bool enabled);
+	bool isMmapEnabled() const;
+	ErrorCode open() override;
+	ErrorCode close() override;
+	ErrorCode read(uint64_t offset, void* buffer, size_t size) override;
+	ErrorCode write(uint64_t offset, const void* buffer, size_t size) override;
+	ErrorCode readVector(uint64_t offset, const iovec *vectors, size_t count, size_t size) override;
+	ErrorCode writeVector(uint64_t offset, const iovec *vectors, size_t count, size_t size) override;
+	ErrorCode readBatch(std::vector<IoUringRequest> &requests) override;
+	uint8_t *memory(uint64_t offset, size_t size) override;
+	bool isMemoryBacked() const override;
+	ErrorCode sync(bool dataOnly) override;
+};
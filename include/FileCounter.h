@@ -1,12 +1,17 @@
 #pragma once
 
+#include <mutex>
 #include <unordered_map>
+#include <vector>
+#include <cstdint>
 #include "Type.h"
 
 struct FileCounter
 {
 	std::unordered_map<Ino, uint32_t> counter;
+	mutable std::mutex mutex;
 	void add(Ino ino);
-	void remove(Ino ino);
+	void remove(Ino ino, uint64_t count = 1);
 	bool empty(Ino ino) const;
+	std::vector<Ino> inodes() const;
 };
\ No newline at end of file
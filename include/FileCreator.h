@@ -2,6 +2,7 @@
 #include "DirWriter.h"
 #include "DirReader.h"
 #include "InodeReader.h"
+#include "DirIndex.h"
 #include <string>
 
 struct FileCreator
@@ -10,11 +11,15 @@ struct FileCreator
 	InodeWriter *inodeWriter;
 	DirReader *dirReader;
 	DirWriter *dirWriter;
+	DirIndex *dirIndex;
 	Allocator *imapAllocator;
+	uint32_t inodesPerBlock = 1;
 	void setInodeReader(InodeReader &inodeReader);
 	void setInodeWriter(InodeWriter &inodeWriter);
 	void setDirReader(DirReader &dirReader);
 	void setDirWriter(DirWriter &dirWriter);
+	void setDirIndex(DirIndex &dirIndex);
 	void setImapAllocator(Allocator &imapAllocator);
+	void setInodesPerBlock(uint32_t inodesPerBlock);
 	Ino createFile(Ino parentInodeNumber, const std::string &name, uint16_t mode, uint16_t uid, uint16_t gid, ErrorCode &outError);
 };
\ No newline at end of file
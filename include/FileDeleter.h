@@ -1,8 +1,8 @@
 #pragma once
 
+#include <vector>
 #include "Allocator.h"
 #include "FileWriter.h"
-#include "FileCounter.h"
 #include "DirReader.h"
 #include "DirWriter.h"
 #include "InodeReader.h"
@@ -12,14 +12,13 @@ struct FileDeleter
 {
 	Allocator *imapAllocator;
 	FileWriter *fileWriter;
-	FileCounter *fileCounter;
 	DirReader *dirReader;
 	DirWriter *dirWriter;
 	InodeReader *inodeReader;
 	InodeWriter *inodeWriter;
+	std::vector<Ino> orphans;
 	void setImapAllocator(Allocator &imapAllocator);
 	void setFileWriter(FileWriter &fileWriter);
-	void setFileCounter(FileCounter &fileCounter);
 	void setDirReader(DirReader &dirReader);
 	void setDirWriter(DirWriter &dirWriter);
 	void setInodeReader(InodeReader &inodeReader);
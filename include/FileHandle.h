@@ -0,0 +1,11 @@
+#pragma once
+
+#include "Type.h"
+#include "Readahead.h"
+
+struct FileHandle
+{
+	Ino inodeNumber;
+	ReadaheadState readahead;
+	explicit FileHandle(Ino inodeNumber): inodeNumber(inodeNumber) {}
+};
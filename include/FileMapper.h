@@ -1,12 +1,24 @@
 #pragma once
 
 #include <cstdint>
+#include <vector>
 #include "Inode.h"
 #include "InodeReader.h"
 #include "IndirectBlock.h"
 #include "BlockDevice.h"
 #include "Allocator.h"
 
+struct SequentialZoneReservation
+{
+	Allocator *zmapAllocator;
+	Zno next = 0;
+	Zno end = 0;
+	uint32_t wanted = 0;
+	Zno goal = 0;
+	~SequentialZoneReservation();
+	ErrorCode release();
+};
+
 struct FileMapper
 {
 	uint32_t zonesPerIndirectBlock;
@@ -15,13 +27,16 @@ struct FileMapper
 	BlockDevice *blockDevice;
 	InodeReader *inodeReader;
 	Allocator *zmapAllocator;
+	std::vector<uint8_t> zeroZone;
 	void setBlockDevice(BlockDevice &blockDevice);
 	void setInodeReader(InodeReader &inodeReader);
 	void setZonesPerIndirectBlock(uint32_t zonesPerIndirectBlock);
 	void setBlocksPerZone(uint32_t blocksPerZone);
 	void setBlockSize(uint32_t blockSize);
 	void setZmapAllocator(Allocator &zmapAllocator);
-	ErrorCode mapLogicalToPhysical(MinixInode3 &inode, Zno logicalZoneIndex, Zno &outPhysicalZoneIndex, bool allocateIfNotMapped = false, bool freeIfMapped = false, bool allocateWriteZero = true);
+	ErrorCode mapLogicalToPhysical(MinixInode3 &inode, Zno logicalZoneIndex, Zno &outPhysicalZoneIndex, bool allocateIfNotMapped = false, bool freeIfMapped = false, bool allocateWriteZero = true, SequentialZoneReservation *reservation = nullptr);
+	const uint8_t *zeroZoneData();
+	ErrorCode lookupMapped(const MinixInode3 &inode, Zno logicalZoneIndex, Zno &outPhysicalZoneIndex);
 	ErrorCode freeLogicalZone(MinixInode3 &inode, Zno logicalZoneIndex);
 	bool isIndirectBlockEmpty(const IndirectBlock &block) const;
 };
\ No newline at end of file
@@ -9,17 +9,20 @@
 
 struct FileWriter
 {
-	uint8_t zoneBuffer[MINIX3_MAX_BLOCK_SIZE << MAX_LOG_ZONE_SIZE];
 	BlockDevice *blockDevice;
 	FileMapper *fileMapper;
 	InodeReader *inodeReader;
 	InodeWriter *inodeWriter;
+	Allocator *zmapAllocator;
 	Layout *layout;
+	bool orderedData = false;
 	void setBlockDevice(BlockDevice &blockDevice);
 	void setFileMapper(FileMapper &fileMapper);
 	void setInodeReader(InodeReader &inodeReader);
 	void setInodeWriter(InodeWriter &inodeWriter);
 	void setLayout(Layout &layout);
+	void setZmapAllocator(Allocator &zmapAllocator);
+	void setOrderedData(bool enabled);
 	ErrorCode writeFile(Ino inodeNumber, const uint8_t *data, uint32_t offset, uint32_t sizeToWrite);
 	ErrorCode truncateFile(Ino inodeNumber, uint32_t newSize);
 };
\ No newline at end of file
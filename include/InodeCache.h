@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "Type.h"
+#include "Errors.h"
+#include "Layout.h"
+#include "Inode.h"
+#include "BlockDevice.h"
+
+struct InodeCacheEntry
+{
+	MinixInode3 inode;
+	uint32_t refCount;
+	std::list<Ino>::iterator lruPosition;
+};
+
+struct InodeCache
+{
+	Layout *layout = nullptr;
+	BlockDevice *blockDevice = nullptr;
+	uint32_t capacity = INODE_CACHE_DEFAULT_CAPACITY;
+	bool isInTransaction = false;
+	std::thread::id transactionOwner;
+	std::mutex mutex;
+	std::unordered_map<Ino, InodeCacheEntry> entries;
+	std::list<Ino> lru;
+	std::unordered_map<Ino, MinixInode3> transactionDirtyInodes;
+	void setLayout(Layout &layout);
+	void setBlockDevice(BlockDevice &blockDevice);
+	void setCapacity(uint32_t capacity);
+	ErrorCode readInode(Ino inodeNumber, void* buffer);
+	ErrorCode readInodes(const std::vector<Ino> &inodeNumbers, MinixInode3 *buffers);
+	ErrorCode writeInode(Ino inodeNumber, const void* buffer);
+	ErrorCode acquire(Ino inodeNumber);
+	void release(Ino inodeNumber);
+	ErrorCode beginTransaction();
+	ErrorCode revertTransaction();
+	ErrorCode commitTransaction();
+	void clear();
+	bool ownsTransaction() const;
+	InodeCacheEntry *lookup(Ino inodeNumber, std::unique_lock<std::mutex> &lock, ErrorCode &outError);
+	void store(Ino inodeNumber, const MinixInode3 &inode);
+	void evict();
+	ErrorCode writeBack(const std::unordered_map<Ino, MinixInode3> &inodes);
+};
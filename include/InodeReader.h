@@ -3,16 +3,19 @@
 #include "Type.h"
 #include "Errors.h"
 #include "Layout.h"
-#include "BlockDevice.h"
+#include "InodeCache.h"
 #include "Constants.h"
+#include <vector>
+#include <sys/stat.h>
 
 struct InodeReader
 {
-	uint8_t blockBuffer[MINIX3_MAX_BLOCK_SIZE];
 	Layout *layout;
-	BlockDevice *blockDevice;
+	InodeCache *inodeCache;
 	void setLayout(Layout &layout);
-	void setBlockDevice(BlockDevice &blockDevice);
+	void setInodeCache(InodeCache &inodeCache);
 	ErrorCode readInode(Ino inodeNumber, void* buffer);
 	struct stat readStat(Ino inodeNumber, ErrorCode &outError);
+	ErrorCode readStats(const std::vector<Ino> &inodeNumbers, std::vector<struct stat> &outStats);
+	struct stat inodeToStat(Ino inodeNumber, const MinixInode3 &inode);
 };
\ No newline at end of file
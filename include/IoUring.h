@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <sys/uio.h>
+#include <vector>
+#include "Errors.h"
+
+struct IoUringRequest
+{
+	uint64_t offset;
+	const iovec *vectors;
+	uint32_t vectorCount;
+	uint32_t size;
+	int32_t result;
+};
+
+class IoUring
+{
+private:
+	int ringFd;
+	uint32_t entries;
+	void *sqRing;
+	void *cqRing;
+	size_t sqRingSize;
+	size_t cqRingSize;
+	void *sqes;
+	size_t sqesSize;
+	uint32_t *sqTail;
+	uint32_t *sqMask;
+	uint32_t *sqArray;
+	uint32_t *cqHead;
+	uint32_t *cqTail;
+	uint32_t *cqMask;
+	void *cqes;
+	std::mutex mutex;
+	ErrorCode enter(uint32_t toSubmit, uint32_t minComplete, uint32_t &outSubmitted);
+public:
+	IoUring();
+	~IoUring();
+	ErrorCode init(int fd, uint32_t queueDepth);
+	void release();
+	bool isEnabled() const;
+	ErrorCode read(std::vector<IoUringRequest> &requests);
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "Errors.h"
+#include "Type.h"
+#include "BlockBackend.h"
+#include "TransactionWriteSet.h"
+
+struct JournalRecordHeader
+{
+	uint32_t magic;
+	uint32_t blockSize;
+	uint64_t sequence;
+	uint32_t blockCount;
+	uint32_t reserved;
+	uint64_t checksum;
+};
+
+class Journal
+{
+private:
+	std::string journalPath;
+	int fd;
+	uint64_t fileSize;
+	uint64_t nextSequence;
+	std::vector<uint8_t> pending;
+	std::unordered_set<Bno> journaledBlocks;
+	bool inPlaceDataUnsynced;
+	std::mutex mutex;
+	ErrorCode flushLocked(BlockBackend &backend);
+public:
+	Journal();
+	~Journal();
+	void setPath(const std::string &path);
+	bool isEnabled() const;
+	ErrorCode open();
+	ErrorCode replay(BlockBackend &backend);
+	ErrorCode append(const TransactionWriteSet &writes, uint16_t blockSize);
+	size_t pendingBytes();
+	uint64_t size();
+	bool contains(Bno firstBlock, Bno endBlock);
+	void markInPlaceData();
+	ErrorCode flush(BlockBackend &backend);
+	ErrorCode reset();
+	ErrorCode close();
+};
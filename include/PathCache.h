@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Type.h"
+#include "Errors.h"
+#include "Constants.h"
+
+struct PathCacheEntry
+{
+	Ino inodeNumbers[2];
+	std::list<std::string>::iterator lruPosition;
+};
+
+struct PathCache
+{
+	uint32_t capacity = PATH_CACHE_DEFAULT_CAPACITY;
+	uint64_t generation = 0;
+	bool isInTransaction = false;
+	std::mutex mutex;
+	std::unordered_map<std::string, PathCacheEntry> entries;
+	std::set<std::string> orderedPaths;
+	std::list<std::string> lru;
+	void setCapacity(uint32_t capacity);
+	bool lookup(const std::string &canonicalPath, bool resolveLastLink, Ino &outInodeNumber);
+	uint64_t getGeneration();
+	void insert(const std::string &canonicalPath, bool resolveLastLink, Ino inodeNumber, uint64_t lookupGeneration);
+	void invalidate(const std::string &path, bool followedLink);
+	ErrorCode beginTransaction();
+	ErrorCode revertTransaction();
+	ErrorCode commitTransaction();
+	void clear();
+	void erase(const std::string &canonicalPath);
+	void evict();
+};
+
+std::string canonicalPath(const std::vector<std::string> &components);
@@ -2,17 +2,28 @@
 
 #include "DirReader.h"
 #include "LinkReader.h"
+#include "DentryCache.h"
+#include "PathCache.h"
+#include "DirIndex.h"
 
 struct PathResolver
 {
 	InodeReader *inodeReader;
 	DirReader *dirReader;
 	LinkReader *linkReader;
-	uint32_t resolvePathDepth = 0;
-	bool resolvePathInProgress = false;
+	DentryCache *dentryCache;
+	PathCache *pathCache;
+	DirIndex *dirIndex;
+	static thread_local uint32_t resolvePathDepth;
+	static thread_local bool resolvePathInProgress;
+	static thread_local bool resolvePathFollowedLink;
 	void setInodeReader(InodeReader &inodeReader);
 	void setDirReader(DirReader &dirReader);
 	void setLinkReader(LinkReader &linkReader);
+	void setDentryCache(DentryCache &dentryCache);
+	void setPathCache(PathCache &pathCache);
+	void setDirIndex(DirIndex &dirIndex);
+	Ino lookupEntry(Ino parentInodeNumber, const std::string &name, uint32_t &outEntryIndex, ErrorCode &outError);
 	Ino getInodeFromParentAndName(Ino parentInodeNumber, const std::string &name, ErrorCode &outError);
 	uint32_t getIdxFromParentAndName(Ino parentInodeNumber, const std::string &name, ErrorCode &outError);
 	Ino resolvePath(const std::string &path, ErrorCode &outError, Ino currentInode = MINIX3_ROOT_INODE, bool resolveLastLink = true);
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "BlockBackend.h"
+
+class RamBackend: public BlockBackend
+{
+private:
+	std::string imagePath;
+	std::vector<uint8_t> image;
+public:
+	RamBackend(const std::string &path);
+	RamBackend(std::vector<uint8_t> data);
+	const std::vector<uint8_t> &getImage() const;
+	ErrorCode save(const std::string &path) const;
+	ErrorCode open() override;
+	ErrorCode close() override;
+	ErrorCode read(uint64_t offset, void* buffer, size_t size) override;
+	ErrorCode write(uint64_t offset, const void* buffer, size_t size) override;
+	ErrorCode readVector(uint64_t offset, const iovec *vectors, size_t count, size_t size) override;
+	ErrorCode writeVector(uint64_t offset, const iovec *vectors, size_t count, size_t size) override;
+	ErrorCode readBatch(std::vector<IoUringRequest> &requests) override;
+	uint8_t *memory(uint64_t offset, size_t size) override;
+	bool isMemoryBacked() const override;
+	ErrorCode sync(bool dataOnly) override;
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Errors.h"
+#include "Type.h"
+#include "Layout.h"
+#include "InodeReader.h"
+#include "FileReader.h"
+#include "TransactionManager.h"
+
+struct ReadaheadState
+{
+	std::mutex mutex;
+	uint64_t nextOffset = 0;
+	uint32_t windowZones = 0;
+	uint64_t prefetchedEnd = 0;
+};
+
+struct ReadaheadRequest
+{
+	Ino inodeNumber;
+	uint32_t offset;
+	uint32_t size;
+};
+
+struct Readahead
+{
+	Layout *layout;
+	InodeReader *inodeReader;
+	FileReader *fileReader;
+	TransactionManager *transactionManager;
+	uint32_t maxWindowZones = 0;
+	std::mutex mutex;
+	std::condition_variable wakeup;
+	std::deque<ReadaheadRequest> queue;
+	std::thread worker;
+	bool stopping = false;
+	std::vector<uint8_t> buffer;
+	void setLayout(Layout &layout);
+	void setInodeReader(InodeReader &inodeReader);
+	void setFileReader(FileReader &fileReader);
+	void setTransactionManager(TransactionManager &transactionManager);
+	void setMaxWindowZones(uint32_t zones);
+	void onRead(ReadaheadState &state, Ino inodeNumber, uint32_t offset, uint32_t size);
+	void schedule(const ReadaheadRequest &request);
+	void run();
+	void prefetch(const ReadaheadRequest &request);
+	void stop();
+};
@@ -1,20 +1,38 @@
 #pragma once
 
+#include <mutex>
+#include <shared_mutex>
 #include "BlockDevice.h"
 #include "Allocator.h"
+#include "InodeCache.h"
+#include "DentryCache.h"
+#include "PathCache.h"
+#include "DirIndex.h"
 
 struct TransactionManager
 {
 	BlockDevice *blockDevice;
 	Allocator *imapAllocator;
 	Allocator *zmapAllocator;
+	InodeCache *inodeCache;
+	DentryCache *dentryCache;
+	PathCache *pathCache;
+	DirIndex *dirIndex;
 	bool isInTransaction = false;
 	bool writeLocked = false;
 	ErrorCode writeLockedReason = SUCCESS;
+	std::mutex writerMutex;
+	std::shared_mutex commitMutex;
 	bool isWriteLocked() const;
 	void setBlockDevice(BlockDevice &blockDevice);
 	void setImapAllocator(Allocator &imapAllocator);
 	void setZmapAllocator(Allocator &zmapAllocator);
+	void setInodeCache(InodeCache &inodeCache);
+	void setDentryCache(DentryCache &dentryCache);
+	void setPathCache(PathCache &pathCache);
+	void setDirIndex(DirIndex &dirIndex);
+	std::unique_lock<std::mutex> lockForWrite();
+	std::shared_lock<std::shared_mutex> lockForRead();
 	ErrorCode beginTransaction();
 	ErrorCode revertTransaction();
 	ErrorCode commitTransaction();
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Type.h"
+
+class TransactionWriteSet
+{
+private:
+	uint32_t blockSize;
+	std::vector<uint8_t*> chunks;
+	std::vector<Bno> blocks;
+	std::vector<uint32_t> index;
+	std::vector<uint32_t> order;
+	uint32_t position(Bno blockNumber) const;
+	void grow();
+public:
+	TransactionWriteSet();
+	~TransactionWriteSet();
+	void setBlockSize(uint32_t size);
+	void release();
+	size_t size() const;
+	uint8_t *find(Bno blockNumber) const;
+	uint8_t *insert(Bno blockNumber);
+	void clear();
+	const std::vector<uint32_t> &sortedSlots();
+	Bno blockAt(uint32_t slot) const;
+	uint8_t *dataAt(uint32_t slot) const;
+};
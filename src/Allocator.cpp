@@ -1,4 +1,7 @@
 #include "Allocator.h"
+#include "Constants.h"
+#include <algorithm>
+#include <thread>
 
 Allocator::Allocator() {}
 
@@ -20,6 +23,11 @@ void Allocator::setBlockDevice(BlockDevice &bd)
 	this->blockDevice = &bd;
 }
 
+void Allocator::setGroupBits(uint32_t groupBits)
+{
+	groupWords = groupBits == 0 ? 0 : std::max(groupBits / 64, 1u);
+}
+
 ErrorCode Allocator::init(uint32_t bmapStartBlock, uint32_t totalBmaps, uint32_t firstFreeBmap, uint32_t blockSize)
 {
 	if (firstFreeBmap >= totalBmaps)
@@ -33,7 +41,8 @@ ErrorCode Allocator::init(uint32_t bmapStartBlock, uint32_t totalBmaps, uint32_t
 	this->blockSize = blockSize;
 	this->bitsPerBlock = blockSize * sizeof(uint8_t) * 8;
 	this->totalBlocks = (totalBmaps - firstFreeBmap + 1 + this->bitsPerBlock - 1) / this->bitsPerBlock;
-	this->bmapCache = static_cast<uint8_t*>(malloc(totalBlocks * blockSize));
+	this->totalWords = totalBlocks * blockSize / sizeof(uint64_t);
+	this->bmapCache = static_cast<uint64_t*>(malloc(totalBlocks * blockSize));
 	if (bmapCache == nullptr)
 	{
 		return ERROR_CANNOT_ALLOCATE_MEMORY;
@@ -45,18 +54,24 @@ ErrorCode Allocator::init(uint32_t bmapStartBlock, uint32_t totalBmaps, uint32_t
 		bmapCache = nullptr;
 		return err;
 	}
+	transactionDirtyWords.clear();
+	transactionWordMask.assign((totalWords + 63) / 64, 0);
+	transactionCountDelta = 0;
+	transactionGroupDeltas.clear();
+	buildSummaries();
 	return SUCCESS;
 }
 
 ErrorCode Allocator::sync()
 {
+	std::lock_guard<std::mutex> lock(mutex);
 	if (isInTransaction)
 	{
 		return ERROR_IS_IN_TRANSACTION;
 	}
 	for (Bno i : dirtyBlockSet)
 	{
-		ErrorCode err = blockDevice->writeBlock(bmapStartBlock + i, bmapCache + i * blockSize);
+		ErrorCode err = blockDevice->writeBlock(bmapStartBlock + i, reinterpret_cast<uint8_t*>(bmapCache) + i * blockSize);
 		if (err != SUCCESS)
 		{
 			return err;
@@ -66,6 +81,202 @@ ErrorCode Allocator::sync()
 	return SUCCESS;
 }
 
+void Allocator::buildSummaries()
+{
+	chunkCount = (totalWords + 63) / 64;
+	regionCount = (chunkCount + 63) / 64;
+	freeWordBits.assign(chunkCount, 0);
+	freeChunkBits.assign(regionCount, 0);
+	staleChunkBits.assign(regionCount, 0);
+	staleRegionBits.assign((regionCount + 63) / 64, 0);
+	chunkRuns.assign(chunkCount, FreeRunSummary{});
+	regionRuns.assign(regionCount, FreeRunSummary{});
+	uint32_t threadCount = std::max(1u, std::min(std::thread::hardware_concurrency(), chunkCount / ALLOCATOR_SUMMARY_PARALLEL_CHUNKS));
+	std::vector<uint32_t> partialCounts(threadCount, 0);
+	auto buildRange = [&](uint32_t index)
+	{
+		uint32_t firstChunk = static_cast<uint32_t>(static_cast<uint64_t>(chunkCount) * index / threadCount);
+		uint32_t endChunk = static_cast<uint32_t>(static_cast<uint64_t>(chunkCount) * (index + 1) / threadCount);
+		for (uint32_t chunk = firstChunk; chunk < endChunk; chunk++)
+		{
+			buildChunk(chunk);
+		}
+		for (uint32_t word = firstChunk * 64; word < std::min(endChunk * 64, totalWords); word++)
+		{
+			partialCounts[index] += static_cast<uint32_t>(__builtin_popcountll(bmapCache[word] & usableBits(word)));
+		}
+	};
+	std::vector<std::thread> workers;
+	for (uint32_t i = 1; i < threadCount; i++)
+	{
+		workers.emplace_back(buildRange, i);
+	}
+	buildRange(0);
+	for (std::thread &worker : workers)
+	{
+		worker.join();
+	}
+	for (uint32_t region = 0; region < regionCount; region++)
+	{
+		buildRegion(region);
+	}
+	allocatedCount = 0;
+	for (uint32_t count : partialCounts)
+	{
+		allocatedCount += count;
+	}
+	if (groupWords != 0)
+	{
+		uint32_t usedWords = (totalBmaps - firstFreeBmap + 1 + 63) / 64;
+		groupFreeCounts.assign((usedWords + groupWords - 1) / groupWords, 0);
+		for (uint32_t word = 0; word < usedWords; word++)
+		{
+			groupFreeCounts[word / groupWords] += static_cast<uint32_t>(__builtin_popcountll(freeBitsAt(word)));
+		}
+	}
+}
+
+FreeRunSummary Allocator::wordRuns(uint64_t freeBits)
+{
+	if (freeBits == ~0ull)
+	{
+		return FreeRunSummary{64, 64, 64};
+	}
+	FreeRunSummary summary;
+	summary.prefix = static_cast<uint32_t>(__builtin_ctzll(~freeBits));
+	summary.suffix = static_cast<uint32_t>(__builtin_clzll(~freeBits));
+	summary.longest = 0;
+	for (uint64_t bits = freeBits; bits != 0; bits &= bits >> 1)
+	{
+		summary.longest++;
+	}
+	return summary;
+}
+
+FreeRunSummary Allocator::combineRuns(const FreeRunSummary &left, uint32_t leftBits, const FreeRunSummary &right, uint32_t rightBits)
+{
+	FreeRunSummary summary;
+	summary.prefix = left.prefix == leftBits ? leftBits + right.prefix : left.prefix;
+	summary.suffix = right.suffix == rightBits ? rightBits + left.suffix : right.suffix;
+	summary.longest = std::max({left.longest, right.longest, left.suffix + right.prefix});
+	return summary;
+}
+
+void Allocator::buildChunk(uint32_t chunk)
+{
+	FreeRunSummary summary{};
+	uint64_t wordBits = 0;
+	for (uint32_t i = 0; i < 64; i++)
+	{
+		uint64_t freeBits = freeBitsAt(chunk * 64 + i);
+		if (freeBits != 0)
+		{
+			wordBits |= 1ull << i;
+		}
+		summary = i == 0 ? wordRuns(freeBits) : combineRuns(summary, i * 64, wordRuns(freeBits), 64);
+	}
+	freeWordBits[chunk] = wordBits;
+	chunkRuns[chunk] = summary;
+}
+
+void Allocator::buildRegion(uint32_t region)
+{
+	FreeRunSummary summary{};
+	uint64_t chunkBits = 0;
+	for (uint32_t i = 0; i < 64 && region * 64 + i < chunkCount; i++)
+	{
+		uint32_t chunk = region * 64 + i;
+		if (freeWordBits[chunk] != 0)
+		{
+			chunkBits |= 1ull << i;
+		}
+		summary = i == 0 ? chunkRuns[chunk] : combineRuns(summary, i * ALLOCATOR_CHUNK_BITS, chunkRuns[chunk], ALLOCATOR_CHUNK_BITS);
+	}
+	freeChunkBits[region] = chunkBits;
+	regionRuns[region] = summary;
+}
+
+void Allocator::noteWordChanged(uint32_t word)
+{
+	uint32_t chunk = word / 64;
+	if (freeBitsAt(word) != 0)
+	{
+		freeWordBits[chunk] |= 1ull << (word % 64);
+		freeChunkBits[chunk / 64] |= 1ull << (chunk % 64);
+	}
+	else
+	{
+		freeWordBits[chunk] &= ~(1ull << (word % 64));
+		if (freeWordBits[chunk] == 0)
+		{
+			freeChunkBits[chunk / 64] &= ~(1ull << (chunk % 64));
+		}
+	}
+	staleChunkBits[chunk / 64] |= 1ull << (chunk % 64);
+	staleRegionBits[chunk / 64 / 64] |= 1ull << (chunk / 64 % 64);
+}
+
+const FreeRunSummary &Allocator::chunkSummary(uint32_t chunk)
+{
+	uint64_t &stale = staleChunkBits[chunk / 64];
+	if ((stale >> (chunk % 64) & 1) != 0)
+	{
+		buildChunk(chunk);
+		stale &= ~(1ull << (chunk % 64));
+	}
+	return chunkRuns[chunk];
+}
+
+const FreeRunSummary &Allocator::regionSummary(uint32_t region)
+{
+	uint64_t &stale = staleRegionBits[region / 64];
+	if ((stale >> (region % 64) & 1) != 0)
+	{
+		for (uint64_t chunks = staleChunkBits[region]; chunks != 0; chunks &= chunks - 1)
+		{
+			buildChunk(region * 64 + static_cast<uint32_t>(__builtin_ctzll(chunks)));
+		}
+		staleChunkBits[region] = 0;
+		buildRegion(region);
+		stale &= ~(1ull << (region % 64));
+	}
+	return regionRuns[region];
+}
+
+uint64_t Allocator::wordAt(uint32_t word) const
+{
+	if ((transactionWordMask[word / 64] >> (word % 64) & 1) != 0)
+	{
+		return transactionDirtyWords.find(word)->second;
+	}
+	return bmapCache[word];
+}
+
+uint64_t Allocator::freeBitsAt(uint32_t word) const
+{
+	if (word >= totalWords)
+	{
+		return 0;
+	}
+	return ~wordAt(word) & usableBits(word);
+}
+
+uint64_t Allocator::usableBits(uint32_t word) const
+{
+	uint64_t mask = ~0ull;
+	if (word == 0)
+	{
+		mask &= ~1ull;
+	}
+	uint64_t endBit = static_cast<uint64_t>(totalBmaps - firstFreeBmap + 1);
+	uint64_t wordStart = static_cast<uint64_t>(word) * 64;
+	if (wordStart + 64 > endBit)
+	{
+		mask = endBit <= wordStart ? 0 : mask & ((1ull << (endBit - wordStart)) - 1);
+	}
+	return mask;
+}
+
 bool Allocator::setBit(uint32_t idx, bool value)
 {
 	if (idx >= totalBmaps || idx < firstFreeBmap)
@@ -73,96 +284,293 @@ bool Allocator::setBit(uint32_t idx, bool value)
 		return false;
 	}
 	uint32_t bitIdx = idx - firstFreeBmap + 1;
-	uint32_t block = bitIdx / bitsPerBlock;
-	uint32_t bitInBlock = bitIdx % bitsPerBlock;
-	uint32_t byteInBlock = bitInBlock / 8;
-	uint8_t bitMask = 1 << (bitInBlock % 8);
+	uint32_t word = bitIdx / 64;
+	uint64_t bitMask = 1ull << (bitIdx % 64);
+	uint64_t *target;
 	if (isInTransaction)
 	{
-		auto it = transactionDirtyBlocks.find(block * blockSize + byteInBlock);
-		if (it == transactionDirtyBlocks.end())
+		uint64_t &maskWord = transactionWordMask[word / 64];
+		if ((maskWord >> (word % 64) & 1) == 0)
 		{
-			uint32_t byteIdx = block * blockSize + byteInBlock;
-			uint8_t byte = bmapCache[byteIdx];
-			bool oldValue = (byte & bitMask) != 0;
-			if (value == oldValue)
-			{
-				return false;
-			}
-			if (value)
-			{
-				byte |= bitMask;
-			}
-			else
-			{
-				byte &= ~bitMask;
-			}
-			transactionDirtyBlocks[byteIdx] = byte;
-			return true;
+			maskWord |= 1ull << (word % 64);
+			target = &transactionDirtyWords.emplace(word, bmapCache[word]).first->second;
 		}
 		else
 		{
-			uint8_t &byte = transactionDirtyBlocks[block * blockSize + byteInBlock];
-			bool oldValue = (byte & bitMask) != 0;
-			if (value == oldValue)
-			{
-				return false;
-			}
-			if (value)
-			{
-				byte |= bitMask;
-			}
-			else
-			{
-				byte &= ~bitMask;
-			}
-			return true;
+			target = &transactionDirtyWords.find(word)->second;
 		}
 	}
-	uint8_t &byte = bmapCache[block * blockSize + byteInBlock];
-	bool oldValue = (byte & bitMask) != 0;
+	else
+	{
+		target = &bmapCache[word];
+	}
+	bool oldValue = (*target & bitMask) != 0;
 	if (value == oldValue)
 	{
 		return false;
 	}
 	if (value)
 	{
-		byte |= bitMask;
+		*target |= bitMask;
 	}
 	else
 	{
-		byte &= ~bitMask;
+		*target &= ~bitMask;
+	}
+	noteWordChanged(word);
+	if (isInTransaction)
+	{
+		transactionCountDelta += value ? 1 : -1;
+		if (groupWords != 0)
+		{
+			transactionGroupDeltas[word / groupWords] += value ? 1 : -1;
+		}
+	}
+	else
+	{
+		allocatedCount += value ? 1 : -1;
+		if (groupWords != 0)
+		{
+			groupFreeCounts[word / groupWords] -= value ? 1 : -1;
+		}
+		dirtyBlockSet.insert(word * sizeof(uint64_t) / blockSize);
 	}
-	dirtyBlockSet.insert(block);
 	return true;
 }
 
-uint32_t Allocator::allocateBmap(ErrorCode &outError)
+bool Allocator::nextFreeWord(uint32_t firstWord, uint32_t endWord, uint32_t &outWord) const
 {
-	for(uint32_t i = lstAllocated; true; )
+	endWord = std::min(endWord, totalWords);
+	if (firstWord >= endWord)
 	{
-		if (setBit(i, true))
+		return false;
+	}
+	uint32_t chunk = firstWord / 64;
+	uint64_t wordBits = freeWordBits[chunk] & (~0ull << (firstWord % 64));
+	while (wordBits == 0)
+	{
+		chunk++;
+		if (static_cast<uint64_t>(chunk) * 64 >= endWord)
 		{
-			outError = SUCCESS;
-			lstAllocated = i;
-			return i;
+			return false;
 		}
-		i++;
-		if (i >= totalBmaps)
+		uint32_t region = chunk / 64;
+		uint64_t chunkBits = freeChunkBits[region] & (~0ull << (chunk % 64));
+		while (chunkBits == 0)
 		{
-			i = firstFreeBmap;
+			region++;
+			if (region >= regionCount || static_cast<uint64_t>(region) * 64 * 64 >= endWord)
+			{
+				return false;
+			}
+			chunkBits = freeChunkBits[region];
 		}
-		if (i == lstAllocated)
+		chunk = region * 64 + static_cast<uint32_t>(__builtin_ctzll(chunkBits));
+		wordBits = freeWordBits[chunk];
+	}
+	outWord = chunk * 64 + static_cast<uint32_t>(__builtin_ctzll(wordBits));
+	return outWord < endWord;
+}
+
+bool Allocator::findFree(uint32_t firstWord, uint32_t endWord, uint64_t firstMask, uint32_t &outBit) const
+{
+	if (firstWord >= endWord)
+	{
+		return false;
+	}
+	uint64_t freeBits = freeBitsAt(firstWord) & firstMask;
+	uint32_t word = firstWord;
+	if (freeBits == 0)
+	{
+		if (!nextFreeWord(firstWord + 1, endWord, word))
+		{
+			return false;
+		}
+		freeBits = freeBitsAt(word);
+	}
+	outBit = word * 64 + static_cast<uint32_t>(__builtin_ctzll(freeBits));
+	return true;
+}
+
+uint32_t Allocator::freeRunLength(uint32_t bit, uint32_t limit) const
+{
+	uint32_t length = 0;
+	while (length < limit && (bit + length) / 64 < totalWords)
+	{
+		uint32_t word = (bit + length) / 64;
+		uint32_t shift = (bit + length) % 64;
+		uint64_t taken = ~(freeBitsAt(word) >> shift);
+		uint32_t run = taken == 0 ? 64 : static_cast<uint32_t>(__builtin_ctzll(taken));
+		length += run;
+		if (run < 64 - shift)
 		{
 			break;
 		}
 	}
+	return std::min(length, limit);
+}
+
+bool Allocator::runMayStart(const FreeRunSummary &summary, uint64_t nextBit, uint32_t count) const
+{
+	if (summary.longest >= count)
+	{
+		return true;
+	}
+	if (summary.suffix == 0 || nextBit >= static_cast<uint64_t>(totalWords) * 64)
+	{
+		return false;
+	}
+	return summary.suffix + freeRunLength(static_cast<uint32_t>(nextBit), count - summary.suffix) >= count;
+}
+
+bool Allocator::findFreeRun(uint32_t startBit, uint32_t stopBit, uint32_t count, uint32_t &outBit)
+{
+	uint64_t bit = startBit;
+	while (bit < stopBit)
+	{
+		uint64_t regionBits = static_cast<uint64_t>(ALLOCATOR_CHUNK_BITS) * 64;
+		if (bit % regionBits == 0 && !runMayStart(regionSummary(static_cast<uint32_t>(bit / regionBits)), bit + regionBits, count))
+		{
+			bit += regionBits;
+			continue;
+		}
+		uint64_t chunkEnd = (bit / ALLOCATOR_CHUNK_BITS + 1) * ALLOCATOR_CHUNK_BITS;
+		if (bit % ALLOCATOR_CHUNK_BITS == 0 && !runMayStart(chunkSummary(static_cast<uint32_t>(bit / ALLOCATOR_CHUNK_BITS)), chunkEnd, count))
+		{
+			bit = chunkEnd;
+			continue;
+		}
+		uint32_t freeBit;
+		if (!findFree(static_cast<uint32_t>(bit / 64), static_cast<uint32_t>(chunkEnd / 64), ~0ull << (bit % 64), freeBit))
+		{
+			bit = chunkEnd;
+			continue;
+		}
+		if (freeBit >= stopBit)
+		{
+			return false;
+		}
+		uint32_t length = freeRunLength(freeBit, count);
+		if (length >= count)
+		{
+			outBit = freeBit;
+			return true;
+		}
+		bit = freeBit + length;
+	}
+	return false;
+}
+
+uint32_t Allocator::longestFreeRun()
+{
+	FreeRunSummary summary{};
+	for (uint32_t region = 0; region < regionCount; region++)
+	{
+		uint32_t regionBits = ALLOCATOR_CHUNK_BITS * 64;
+		summary = region == 0 ? regionSummary(region) : combineRuns(summary, region * regionBits, regionSummary(region), regionBits);
+	}
+	return summary.longest;
+}
+
+uint32_t Allocator::allocateNear(uint32_t startBit, ErrorCode &outError)
+{
+	uint32_t startWord = startBit / 64;
+	uint32_t bit;
+	if (findFree(startWord, totalWords, ~0ull << (startBit % 64), bit) || findFree(0, startWord + 1, ~0ull, bit))
+	{
+		uint32_t idx = bit + firstFreeBmap - 1;
+		setBit(idx, true);
+		outError = SUCCESS;
+		lstAllocated = idx;
+		return idx;
+	}
 	outError = ERROR_CANNOT_ALLOCATE_BMAP;
 	return 0;
 }
 
+uint32_t Allocator::allocateBmap(uint32_t hint, ErrorCode &outError)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	uint32_t goal = hint >= firstFreeBmap && hint < totalBmaps ? hint : lstAllocated;
+	return allocateNear(goal - firstFreeBmap + 1, outError);
+}
+
+uint32_t Allocator::groupFree(uint32_t group) const
+{
+	auto delta = transactionGroupDeltas.find(group);
+	return delta == transactionGroupDeltas.end() ? groupFreeCounts[group] : groupFreeCounts[group] - delta->second;
+}
+
+uint32_t Allocator::allocateSpread(uint32_t hint, ErrorCode &outError)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	bool hintValid = hint >= firstFreeBmap && hint < totalBmaps;
+	uint32_t hintBit = (hintValid ? hint : lstAllocated) - firstFreeBmap + 1;
+	if (groupWords == 0)
+	{
+		return allocateNear(hintBit, outError);
+	}
+	uint64_t totalFree = static_cast<uint64_t>(totalBmaps - firstFreeBmap) - allocatedCount - transactionCountDelta;
+	if (totalFree == 0)
+	{
+		outError = ERROR_CANNOT_ALLOCATE_BMAP;
+		return 0;
+	}
+	uint32_t groupCount = static_cast<uint32_t>(groupFreeCounts.size());
+	uint32_t hintGroup = hintBit / 64 / groupWords;
+	if (hintValid && groupFree(hintGroup) > 0 && static_cast<uint64_t>(groupFree(hintGroup)) * groupCount >= totalFree)
+	{
+		return allocateNear(hintBit, outError);
+	}
+	uint32_t bestGroup = hintGroup;
+	uint32_t bestFree = groupFree(hintGroup);
+	for (uint32_t i = 1; i < groupCount; i++)
+	{
+		uint32_t group = (hintGroup + i) % groupCount;
+		uint32_t freeCount = groupFree(group);
+		if (freeCount > bestFree)
+		{
+			bestGroup = group;
+			bestFree = freeCount;
+		}
+	}
+	return allocateNear(bestGroup * groupWords * 64, outError);
+}
+
+uint32_t Allocator::allocateRun(uint32_t count, uint32_t hint, uint32_t &outCount, ErrorCode &outError)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	outCount = 0;
+	uint32_t goal = hint >= firstFreeBmap && hint < totalBmaps ? hint : lstAllocated;
+	uint32_t startBit = goal - firstFreeBmap + 1;
+	uint32_t endBit = totalBmaps - firstFreeBmap + 1;
+	uint32_t wanted = std::max(count, 1u);
+	uint32_t bit = 0;
+	bool found = findFreeRun(startBit, endBit, wanted, bit) || findFreeRun(1, startBit, wanted, bit);
+	if (!found)
+	{
+		wanted = std::min(wanted, longestFreeRun());
+		found = wanted > 0 && findFreeRun(1, endBit, wanted, bit);
+	}
+	if (!found)
+	{
+		outError = ERROR_CANNOT_ALLOCATE_BMAP;
+		return 0;
+	}
+	uint32_t first = bit + firstFreeBmap - 1;
+	for (uint32_t i = 0; i < wanted; i++)
+	{
+		setBit(first + i, true);
+	}
+	lstAllocated = first + wanted - 1;
+	outCount = wanted;
+	outError = SUCCESS;
+	return first;
+}
+
 ErrorCode Allocator::freeBmap(uint32_t idx)
 {
+	std::lock_guard<std::mutex> lock(mutex);
 	if (idx >= totalBmaps || idx < firstFreeBmap)
 	{
 		return ERROR_INVALID_BMAP_INDEX;
@@ -176,6 +584,7 @@ ErrorCode Allocator::freeBmap(uint32_t idx)
 
 ErrorCode Allocator::beginTransaction()
 {
+	std::lock_guard<std::mutex> lock(mutex);
 	if (isInTransaction)
 	{
 		return ERROR_IS_IN_TRANSACTION;
@@ -186,45 +595,61 @@ ErrorCode Allocator::beginTransaction()
 
 ErrorCode Allocator::revertTransaction()
 {
+	std::lock_guard<std::mutex> lock(mutex);
 	if (!isInTransaction)
 	{
 		return ERROR_FS_BROKEN;
 	}
 	isInTransaction = false;
-	transactionDirtyBlocks.clear();
+	for (const auto &[word, value] : transactionDirtyWords)
+	{
+		transactionWordMask[word / 64] = 0;
+		noteWordChanged(word);
+	}
+	transactionDirtyWords.clear();
+	transactionCountDelta = 0;
+	transactionGroupDeltas.clear();
 	return SUCCESS;
 }
 
 ErrorCode Allocator::commitTransaction()
 {
+	std::lock_guard<std::mutex> lock(mutex);
 	if (!isInTransaction)
 	{
 		return ERROR_FS_BROKEN;
 	}
-	for (const auto& [idx, state] : transactionDirtyBlocks)
+	for (const auto &[word, value] : transactionDirtyWords)
 	{
-		bmapCache[idx] = state;
-		dirtyBlockSet.insert(idx / blockSize);
+		bmapCache[word] = value;
+		transactionWordMask[word / 64] = 0;
+		dirtyBlockSet.insert(word * sizeof(uint64_t) / blockSize);
 	}
-	transactionDirtyBlocks.clear();
+	transactionDirtyWords.clear();
+	allocatedCount += transactionCountDelta;
+	transactionCountDelta = 0;
+	for (const auto &[group, delta] : transactionGroupDeltas)
+	{
+		groupFreeCounts[group] -= delta;
+	}
+	transactionGroupDeltas.clear();
 	isInTransaction = false;
 	return SUCCESS;
 }
 
 uint32_t Allocator::getAllocatedCount() const
 {
-	uint32_t count = 0;
-	for(uint32_t i = firstFreeBmap; i < totalBmaps; i++)
+	std::lock_guard<std::mutex> lock(mutex);
+	return allocatedCount;
+}
+
+bool Allocator::isCommittedFree(uint32_t idx) const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (idx >= totalBmaps || idx < firstFreeBmap)
 	{
-		uint32_t bitIdx = i - firstFreeBmap + 1;
-		uint32_t block = bitIdx / bitsPerBlock;
-		uint32_t bitInBlock = bitIdx % bitsPerBlock;
-		uint32_t byteInBlock = bitInBlock / 8;
-		uint8_t bitMask = 1 << (bitInBlock % 8);
-		if ((bmapCache[block * blockSize + byteInBlock] & bitMask) != 0)
-		{
-			count++;
-		}
+		return false;
 	}
-	return count;
+	uint32_t bitIdx = idx - firstFreeBmap + 1;
+	return (bmapCache[bitIdx / 64] >> (bitIdx % 64) & 1) == 0;
 }
\ No newline at end of file
@@ -0,0 +1,320 @@
+#include "BlockCache.h"
+#include "BlockDevice.h"
+#include "Constants.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+
+BlockCache::BlockCache(): blockDevice(nullptr), blockSize(0), capacity(0), shardCount(0), pool(nullptr) {}
+
+BlockCache::~BlockCache()
+{
+	release();
+}
+
+void BlockCache::setBlockDevice(BlockDevice &blockDevice)
+{
+	this->blockDevice = &blockDevice;
+}
+
+ErrorCode BlockCache::init(uint32_t capacity, uint32_t blockSize)
+{
+	release();
+	if (capacity == 0)
+	{
+		return SUCCESS;
+	}
+	void *memory = nullptr;
+	if (posix_memalign(&memory, BLOCK_CACHE_ALIGNMENT, static_cast<size_t>(capacity) * blockSize) != 0)
+	{
+		return ERROR_CANNOT_ALLOCATE_MEMORY;
+	}
+	this->pool = static_cast<uint8_t*>(memory);
+	this->capacity = capacity;
+	this->blockSize = blockSize;
+	this->shardCount = std::min<uint32_t>(BLOCK_CACHE_SHARDS, capacity);
+	this->slots.assign(capacity, BlockCacheSlot{0, false, 0, false, {}});
+	this->shards.reset(new BlockCacheShard[shardCount]);
+	for (uint32_t slot = 0; slot < capacity; slot++)
+	{
+		shards[slot % shardCount].freeSlots.push_back(slot);
+	}
+	return SUCCESS;
+}
+
+void BlockCache::release()
+{
+	shards.reset();
+	slots.clear();
+	if (pool != nullptr)
+	{
+		free(pool);
+		pool = nullptr;
+	}
+	capacity = 0;
+	shardCount = 0;
+}
+
+bool BlockCache::isEnabled() const
+{
+	return capacity != 0;
+}
+
+uint32_t BlockCache::getCapacity() const
+{
+	return capacity;
+}
+
+BlockCacheShard &BlockCache::shardOf(Bno blockNumber)
+{
+	return shards[blockNumber % shardCount];
+}
+
+uint8_t *BlockCache::slotData(uint32_t slot)
+{
+	return pool + static_cast<size_t>(slot) * blockSize;
+}
+
+ErrorCode BlockCache::takeSlot(BlockCacheShard &shard, uint32_t &outSlot)
+{
+	if (!shard.freeSlots.empty())
+	{
+		outSlot = shard.freeSlots.back();
+		shard.freeSlots.pop_back();
+		return SUCCESS;
+	}
+	auto position = shard.lru.end();
+	while (position != shard.lru.begin() && slots[*std::prev(position)].pinCount != 0)
+	{
+		position--;
+	}
+	if (position == shard.lru.begin())
+	{
+		return ERROR_CANNOT_ALLOCATE_MEMORY;
+	}
+	uint32_t victim = *std::prev(position);
+	BlockCacheSlot &victimSlot = slots[victim];
+	if (victimSlot.dirty)
+	{
+		ErrorCode err = blockDevice->flushJournal();
+		if (err != SUCCESS)
+		{
+			return err;
+		}
+		err = blockDevice->writeRaw(static_cast<uint64_t>(victimSlot.blockNumber) * blockSize, slotData(victim), blockSize);
+		if (err != SUCCESS)
+		{
+			return err;
+		}
+		victimSlot.dirty = false;
+	}
+	shard.lru.erase(victimSlot.lruPosition);
+	shard.slotOfBlock.erase(victimSlot.blockNumber);
+	outSlot = victim;
+	return SUCCESS;
+}
+
+bool BlockCache::read(Bno blockNumber, void *buffer)
+{
+	if (capacity == 0)
+	{
+		return false;
+	}
+	BlockCacheShard &shard = shardOf(blockNumber);
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	auto it = shard.slotOfBlock.find(blockNumber);
+	if (it == shard.slotOfBlock.end())
+	{
+		return false;
+	}
+	BlockCacheSlot &slot = slots[it->second];
+	shard.lru.splice(shard.lru.begin(), shard.lru, slot.lruPosition);
+	memcpy(buffer, slotData(it->second), blockSize);
+	return true;
+}
+
+const uint8_t *BlockCache::pin(Bno blockNumber, uint32_t &outSlot)
+{
+	if (capacity == 0)
+	{
+		return nullptr;
+	}
+	BlockCacheShard &shard = shardOf(blockNumber);
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	auto it = shard.slotOfBlock.find(blockNumber);
+	if (it == shard.slotOfBlock.end())
+	{
+		return nullptr;
+	}
+	BlockCacheSlot &slot = slots[it->second];
+	shard.lru.splice(shard.lru.begin(), shard.lru, slot.lruPosition);
+	slot.pinCount++;
+	outSlot = it->second;
+	return slotData(it->second);
+}
+
+void BlockCache::unpin(uint32_t slot)
+{
+	BlockCacheShard &shard = shards[slot % shardCount];
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	BlockCacheSlot &pinned = slots[slot];
+	pinned.pinCount--;
+	if (pinned.pinCount == 0 && pinned.detached)
+	{
+		pinned.detached = false;
+		shard.freeSlots.push_back(slot);
+	}
+}
+
+ErrorCode BlockCache::write(Bno blockNumber, const void *buffer, bool dirty)
+{
+	if (capacity == 0)
+	{
+		return SUCCESS;
+	}
+	BlockCacheShard &shard = shardOf(blockNumber);
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	auto it = shard.slotOfBlock.find(blockNumber);
+	if (it != shard.slotOfBlock.end())
+	{
+		BlockCacheSlot &slot = slots[it->second];
+		shard.lru.splice(shard.lru.begin(), shard.lru, slot.lruPosition);
+		memcpy(slotData(it->second), buffer, blockSize);
+		slot.dirty = slot.dirty || dirty;
+		return SUCCESS;
+	}
+	uint32_t slotIndex;
+	ErrorCode err = takeSlot(shard, slotIndex);
+	if (err == ERROR_CANNOT_ALLOCATE_MEMORY)
+	{
+		if (!dirty)
+		{
+			return SUCCESS;
+		}
+		err = blockDevice->flushJournal();
+		if (err != SUCCESS)
+		{
+			return err;
+		}
+		return blockDevice->writeRaw(static_cast<uint64_t>(blockNumber) * blockSize, buffer, blockSize);
+	}
+	if (err != SUCCESS)
+	{
+		return err;
+	}
+	memcpy(slotData(slotIndex), buffer, blockSize);
+	shard.lru.push_front(slotIndex);
+	slots[slotIndex] = BlockCacheSlot{blockNumber, dirty, 0, false, shard.lru.begin()};
+	shard.slotOfBlock[blockNumber] = slotIndex;
+	return SUCCESS;
+}
+
+void BlockCache::updateIfPresent(Bno blockNumber, const void *buffer)
+{
+	if (capacity == 0)
+	{
+		return;
+	}
+	BlockCacheShard &shard = shardOf(blockNumber);
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	auto it = shard.slotOfBlock.find(blockNumber);
+	if (it == shard.slotOfBlock.end())
+	{
+		return;
+	}
+	memcpy(slotData(it->second), buffer, blockSize);
+	slots[it->second].dirty = false;
+}
+
+void BlockCache::invalidate(Bno blockNumber)
+{
+	if (capacity == 0)
+	{
+		return;
+	}
+	BlockCacheShard &shard = shardOf(blockNumber);
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	auto it = shard.slotOfBlock.find(blockNumber);
+	if (it == shard.slotOfBlock.end())
+	{
+		return;
+	}
+	uint32_t slot = it->second;
+	shard.lru.erase(slots[slot].lruPosition);
+	shard.slotOfBlock.erase(it);
+	slots[slot].dirty = false;
+	if (slots[slot].pinCount != 0)
+	{
+		slots[slot].detached = true;
+		return;
+	}
+	shard.freeSlots.push_back(slot);
+}
+
+ErrorCode BlockCache::flush()
+{
+	if (capacity == 0)
+	{
+		return SUCCESS;
+	}
+	std::vector<std::unique_lock<std::mutex>> locks;
+	locks.reserve(shardCount);
+	std::vector<std::pair<Bno, uint32_t>> dirtySlots;
+	for (uint32_t i = 0; i < shardCount; i++)
+	{
+		locks.emplace_back(shards[i].mutex);
+		for (const auto &[blockNumber, slot] : shards[i].slotOfBlock)
+		{
+			if (slots[slot].dirty)
+			{
+				dirtySlots.emplace_back(blockNumber, slot);
+			}
+		}
+	}
+	if (dirtySlots.empty())
+	{
+		return SUCCESS;
+	}
+	ErrorCode err = blockDevice->flushJournal();
+	if (err != SUCCESS)
+	{
+		return err;
+	}
+	std::sort(dirtySlots.begin(), dirtySlots.end());
+	std::vector<iovec> vectors;
+	vectors.reserve(BLOCK_CACHE_FLUSH_RUN_BLOCKS);
+	size_t runStart = 0;
+	while (runStart < dirtySlots.size())
+	{
+		size_t runEnd = runStart + 1;
+		while (runEnd < dirtySlots.size() && runEnd - runStart < BLOCK_CACHE_FLUSH_RUN_BLOCKS && dirtySlots[runEnd].first == dirtySlots[runEnd - 1].first + 1)
+		{
+			runEnd++;
+		}
+		vectors.clear();
+		for (size_t i = runStart; i < runEnd; i++)
+		{
+			uint8_t *data = slotData(dirtySlots[i].second);
+			if (!vectors.empty() && static_cast<uint8_t*>(vectors.back().iov_base) + vectors.back().iov_len == data)
+			{
+				vectors.back().iov_len += blockSize;
+			}
+			else
+			{
+				vectors.push_back(iovec{data, blockSize});
+			}
+		}
+		err = blockDevice->writeVector(static_cast<uint64_t>(dirtySlots[runStart].first) * blockSize, vectors.data(), vectors.size(), (runEnd - runStart) * blockSize);
+		if (err != SUCCESS)
+		{
+			return err;
+		}
+		for (size_t i = runStart; i < runEnd; i++)
+		{
+			slots[dirtySlots[i].second].dirty = false;
+		}
+		runStart = runEnd;
+	}
+	return SUCCESS;
+}
@@ -1,41 +1,93 @@
 #include "BlockDevice.h"
-#include <unistd.h>
 #include <cstring>
-#include <fcntl.h>
+#include <algorithm>
 #include "Type.h"
 #include "Errors.h"
 #include "Constants.h"
 
-BlockDevice::BlockDevice(): devicePath(""), fd(-1), isInTransaction(false) {}
-BlockDevice::BlockDevice(const std::string &path): devicePath(path), fd(-1), isInTransaction(false) {}
+BlockDevice::BlockDevice(): backend(new FileBackend()), isInTransaction(false), cacheCapacity(BLOCK_CACHE_DEFAULT_BLOCKS)
+{
+	fileBackend = static_cast<FileBackend*>(backend.get());
+	cache.setBlockDevice(*this);
+}
+
+BlockDevice::BlockDevice(const std::string &path): backend(new FileBackend(path)), isInTransaction(false), cacheCapacity(BLOCK_CACHE_DEFAULT_BLOCKS)
+{
+	fileBackend = static_cast<FileBackend*>(backend.get());
+	cache.setBlockDevice(*this);
+}
+
+BlockDevice::BlockDevice(std::unique_ptr<BlockBackend> blockBackend): backend(std::move(blockBackend)), isInTransaction(false), cacheCapacity(BLOCK_CACHE_DEFAULT_BLOCKS)
+{
+	fileBackend = dynamic_cast<FileBackend*>(backend.get());
+	cache.setBlockDevice(*this);
+}
 
 void BlockDevice::setDevicePath(const std::string &path)
 {
-	devicePath = path;
+	if (fileBackend != nullptr)
+	{
+		fileBackend->setDevicePath(path);
+	}
 }
 
 ErrorCode BlockDevice::open()
 {
-	fd = ::open(devicePath.c_str(), O_RDWR);
-	if (fd < 0)
+	ErrorCode err = backend->open();
+	if (err != SUCCESS)
 	{
-		return ERROR_OPEN_DEVICE_FAIL;
+		return err;
+	}
+	err = journal.open();
+	if (err == SUCCESS && journal.isEnabled())
+	{
+		err = journal.replay(*backend);
+	}
+	if (err != SUCCESS)
+	{
+		journal.close();
+		backend->close();
+		return err;
 	}
 	return SUCCESS;
 }
 
 ErrorCode BlockDevice::close()
 {
-	if (::close(fd) < 0)
+	ErrorCode err = cache.flush();
+	if (err != SUCCESS)
 	{
-		return ERROR_CLOSE_DEVICE_FAIL;
+		return err;
 	}
-	return SUCCESS;
+	cache.release();
+	if (journal.isEnabled())
+	{
+		err = backend->sync(false);
+		if (err == SUCCESS)
+		{
+			err = journal.reset();
+		}
+		if (err != SUCCESS)
+		{
+			return err;
+		}
+		err = journal.close();
+		if (err != SUCCESS)
+		{
+			return err;
+		}
+	}
+	return backend->close();
 }
 
 void BlockDevice::setBlockSize(uint16_t size)
 {
 	blockSize = size;
+	transactionWrites.setBlockSize(size);
+	if (fileBackend != nullptr)
+	{
+		fileBackend->setBlockSize(size);
+	}
 }
 
 void BlockDevice::setZoneSize(uint32_t size)
@@ -43,117 +95,397 @@ void BlockDevice::setZoneSize(uint32_t size)
 	zoneSize = size;
 }
 
-ErrorCode BlockDevice::readBytes(uint64_t offset, void* buffer, size_t size)
+void BlockDevice::setCacheCapacity(uint32_t blocks)
 {
-	if (size == 0)
+	cacheCapacity = blocks;
+}
+
+void BlockDevice::setIoUring(bool enabled)
+{
+	if (fileBackend != nullptr)
 	{
-		return SUCCESS;
+		fileBackend->setIoUring(enabled);
 	}
+}
+
+bool BlockDevice::isIoUringEnabled() const
+{
+	return fileBackend != nullptr && fileBackend->isIoUringEnabled();
+}
+
+void BlockDevice::setDirectIO(bool enabled)
+{
+	if (fileBackend != nullptr)
+	{
+		fileBackend->setDirectIO(enabled);
+	}
+}
+
+bool BlockDevice::isDirectIOEnabled() const
+{
+	return fileBackend != nullptr && fileBackend->isDirectIOEnabled();
+}
+
+void BlockDevice::setMmap(bool enabled)
+{
+	if (fileBackend != nullptr)
+	{
+		fileBackend->setMmap(enabled);
+	}
+}
+
+bool BlockDevice::isMmapEnabled() const
+{
+	return fileBackend != nullptr && fileBackend->isMmapEnabled();
+}
+
+void BlockDevice::setJournalPath(const std::string &path)
+{
+	journal.setPath(path);
+}
+
+bool BlockDevice::isJournalEnabled() const
+{
+	return journal.isEnabled();
+}
+
+uint32_t BlockDevice::getCacheCapacity() const
+{
+	return cache.getCapacity();
+}
+
+bool BlockDevice::isMemoryBacked() const
+{
+	return backend->isMemoryBacked();
+}
+
+ErrorCode BlockDevice::initCache()
+{
+	return cache.init(backend->isMemoryBacked() ? 0 : cacheCapacity, blockSize);
+}
+
+bool BlockDevice::ownsTransaction() const
+{
+	return isInTransaction && transactionOwner.load() == std::this_thread::get_id();
+}
+
+ErrorCode BlockDevice::flushJournal()
+{
+	return journal.flush(*backend);
+}
+
+ErrorCode BlockDevice::checkpoint()
+{
+	ErrorCode err = cache.flush();
+	if (err != SUCCESS)
+	{
+		return err;
+	}
+	err = backend->sync(false);
+	if (err != SUCCESS)
+	{
+		return err;
+	}
+	return journal.reset();
+}
+
+ErrorCode BlockDevice::readBytes(uint64_t offset, void* buffer, size_t size)
+{
 	if (isInTransaction)
 	{
 		return ERROR_IS_IN_TRANSACTION;
 	}
-	ssize_t result = pread(fd, buffer, size, offset);
-	int retries = 0;
-	int nowCount = result > 0 ? static_cast<int>(result) : 0;
-	while ((result < 0 || nowCount < size) && retries < MAX_READ_RETRIES)
+	return readRaw(offset, buffer, size);
+}
+
+ErrorCode BlockDevice::readRaw(uint64_t offset, void* buffer, size_t size)
+{
+	if (size == 0)
 	{
-		result = pread(fd, static_cast<uint8_t*>(buffer) + nowCount, size - nowCount, offset + nowCount);
-		if (result > 0)
+		return SUCCESS;
+	}
+	return backend->read(offset, buffer, size);
+}
+
+ErrorCode BlockDevice::readVector(uint64_t offset, const iovec *vectors, size_t count, size_t size)
+{
+	return backend->readVector(offset, vectors, count, size);
+}
+
+ErrorCode BlockDevice::readRawBatch(std::vector<IoUringRequest> &requests)
+{
+	return backend->readBatch(requests);
+}
+
+ErrorCode BlockDevice::readBlock(uint32_t blockNumber, void* buffer)
+{
+	if (ownsTransaction())
+	{
+		const uint8_t *staged = transactionWrites.find(blockNumber);
+		if (staged != nullptr)
 		{
-			nowCount += static_cast<int>(result);
+			memcpy(buffer, staged, blockSize);
+			return SUCCESS;
 		}
-		retries++;
 	}
-	if (nowCount != static_cast<int>(size))
+	if (cache.read(blockNumber, buffer))
 	{
-		return ERROR_READ_FAIL;
+		return SUCCESS;
 	}
-	return SUCCESS;
+	ErrorCode err = readRaw(static_cast<uint64_t>(blockNumber) * blockSize, buffer, blockSize);
+	if (err != SUCCESS)
+	{
+		return err;
+	}
+	return cache.write(blockNumber, buffer, false);
 }
 
-ErrorCode BlockDevice::readBlock(uint32_t blockNumber, void* buffer)
+const uint8_t *BlockDevice::peekBlock(uint32_t blockNumber)
 {
-	if (isInTransaction)
+	if (!backend->isMemoryBacked())
+	{
+		return nullptr;
+	}
+	if (ownsTransaction())
 	{
-		auto it = transactionWrites.find(blockNumber);
-		if (it != transactionWrites.end())
+		const uint8_t *staged = transactionWrites.find(blockNumber);
+		if (staged != nullptr)
 		{
-			memcpy(buffer, it->second.data(), blockSize);
-			return SUCCESS;
+			return staged;
 		}
-		ssize_t result = pread(fd, buffer, blockSize, static_cast<uint64_t>(blockNumber) * blockSize);
-		if (result < blockSize)
+	}
+	return backend->memory(static_cast<uint64_t>(blockNumber) * blockSize, blockSize);
+}
+
+const uint8_t *BlockDevice::pinBlock(uint32_t blockNumber, uint32_t &outPin)
+{
+	outPin = BLOCK_CACHE_NO_PIN;
+	if (backend->isMemoryBacked())
+	{
+		return peekBlock(blockNumber);
+	}
+	if (ownsTransaction())
+	{
+		const uint8_t *staged = transactionWrites.find(blockNumber);
+		if (staged != nullptr)
 		{
-			return ERROR_READ_FAIL;
+			return staged;
 		}
-		return SUCCESS;
 	}
-	uint64_t offset = static_cast<uint64_t>(blockNumber) * blockSize;
-	return readBytes(offset, buffer, blockSize);
+	const uint8_t *cached = cache.pin(blockNumber, outPin);
+	if (cached != nullptr)
+	{
+		return cached;
+	}
+	static thread_local std::vector<uint8_t> scratch;
+	scratch.resize(blockSize);
+	if (readBlock(blockNumber, scratch.data()) != SUCCESS)
+	{
+		return nullptr;
+	}
+	cached = cache.pin(blockNumber, outPin);
+	return cached != nullptr ? cached : scratch.data();
+}
+
+void BlockDevice::unpinBlock(uint32_t pin)
+{
+	if (pin != BLOCK_CACHE_NO_PIN)
+	{
+		cache.unpin(pin);
+	}
 }
 
 ErrorCode BlockDevice::readZone(uint32_t zoneNumber, void* buffer)
 {
-	if (isInTransaction)
+	ZoneRun run{static_cast<uint64_t>(zoneNumber) * zoneSize, static_cast<uint8_t*>(buffer), zoneSize};
+	return readRuns(&run, 1);
+}
+
+ErrorCode BlockDevice::readRuns(const std::vector<ZoneRun> &runs)
+{
+	return readRuns(runs.data(), runs.size());
+}
+
+struct BlockFill
+{
+	Bno blockNumber;
+	uint8_t *data;
+	const uint8_t *patch;
+	uint32_t patchOffset;
+	uint32_t patchSize;
+};
+
+ErrorCode BlockDevice::readRuns(const ZoneRun *runs, size_t count)
+{
+	static thread_local std::vector<IoUringRequest> requests;
+	static thread_local std::vector<size_t> requestVectors;
+	static thread_local std::vector<iovec> vectors;
+	static thread_local std::vector<BlockFill> fills;
+	static thread_local std::vector<uint8_t> scratch;
+	requests.clear();
+	requestVectors.clear();
+	vectors.clear();
+	fills.clear();
+	scratch.resize((2 * count + 1) * blockSize);
+	uint8_t *probe = scratch.data() + 2 * count * blockSize;
+	uint32_t scratchUsed = 0;
+	bool transactional = ownsTransaction();
+	bool caching = cache.isEnabled();
+	uint64_t requestEnd = 0;
+	for (size_t r = 0; r < count; r++)
 	{
-		for (Bno blockNumber = zoneNumber * (zoneSize / blockSize); blockNumber < (zoneNumber + 1) * (zoneSize / blockSize); blockNumber++)
+		uint64_t end = runs[r].offset + runs[r].size;
+		uint64_t position = runs[r].offset;
+		while (position < end)
 		{
-			ErrorCode err = readBlock(blockNumber, static_cast<uint8_t*>(buffer) + (blockNumber - zoneNumber * (zoneSize / blockSize)) * blockSize);
-			if (err != SUCCESS)
+			Bno blockNumber = static_cast<Bno>(position / blockSize);
+			uint64_t blockStart = static_cast<uint64_t>(blockNumber) * blockSize;
+			uint32_t low = static_cast<uint32_t>(position - blockStart);
+			uint32_t high = static_cast<uint32_t>(std::min<uint64_t>(blockSize, end - blockStart));
+			uint8_t *destination = runs[r].buffer + (position - runs[r].offset);
+			uint32_t length = high - low;
+			position = blockStart + high;
+			bool present = false;
+			if (transactional)
 			{
-				return err;
+				const uint8_t *staged = transactionWrites.find(blockNumber);
+				if (staged != nullptr)
+				{
+					memcpy(destination, staged + low, length);
+					present = true;
+				}
+			}
+			if (!present && caching)
+			{
+				if (length == blockSize)
+				{
+					present = cache.read(blockNumber, destination);
+				}
+				else if (cache.read(blockNumber, probe))
+				{
+					memcpy(destination, probe + low, length);
+					present = true;
+				}
+			}
+			if (present)
+			{
+				continue;
+			}
+			uint64_t pieceStart = caching ? blockStart : position - length;
+			if (requests.empty() || pieceStart != requestEnd || vectors.size() - requestVectors.back() + 3 > VECTORED_IO_MAX_SEGMENTS)
+			{
+				requests.push_back(IoUringRequest{pieceStart, nullptr, 0, 0, 0});
+				requestVectors.push_back(vectors.size());
+			}
+			size_t firstVector = requestVectors.back();
+			uint8_t *blockData = destination;
+			if (caching && length != blockSize)
+			{
+				blockData = scratch.data() + scratchUsed * blockSize;
+				scratchUsed++;
+				if (low > 0)
+				{
+					vectors.push_back(iovec{blockData, low});
+				}
+				vectors.push_back(iovec{destination, length});
+				if (high < blockSize)
+				{
+					vectors.push_back(iovec{blockData + high, blockSize - high});
+				}
+				fills.push_back(BlockFill{blockNumber, blockData, destination, low, length});
+			}
+			else
+			{
+				if (vectors.size() > firstVector && static_cast<uint8_t*>(vectors.back().iov_base) + vectors.back().iov_len == destination)
+				{
+					vectors.back().iov_len += length;
+				}
+				else
+				{
+					vectors.push_back(iovec{destination, length});
+				}
+				if (caching)
+				{
+					fills.push_back(BlockFill{blockNumber, blockData, nullptr, 0, 0});
+				}
 			}
+			uint32_t pieceSize = caching ? blockSize : length;
+			requests.back().size += pieceSize;
+			requestEnd = pieceStart + pieceSize;
 		}
-		return SUCCESS;
 	}
-	uint64_t offset = static_cast<uint64_t>(zoneNumber) * zoneSize;
-	return readBytes(offset, buffer, zoneSize);
-}
-
-ErrorCode BlockDevice::writeBytes(uint64_t offset, const void* buffer, size_t size)
-{
-	if (size == 0)
+	for (size_t r = 0; r < requests.size(); r++)
 	{
-		return SUCCESS;
+		size_t nextVector = r + 1 < requests.size() ? requestVectors[r + 1] : vectors.size();
+		requests[r].vectors = vectors.data() + requestVectors[r];
+		requests[r].vectorCount = static_cast<uint32_t>(nextVector - requestVectors[r]);
 	}
-	if (isInTransaction)
+	ErrorCode err = readRawBatch(requests);
+	if (err != SUCCESS)
 	{
-		return ERROR_IS_IN_TRANSACTION;
+		return err;
 	}
-	ssize_t result = pwrite(fd, buffer, size, offset);
-	int retries = 0;
-	int nowCount = result > 0 ? static_cast<int>(result) : 0;
-	while ((result < 0 || nowCount < size) && retries < MAX_READ_RETRIES)
+	for (const BlockFill &fill : fills)
 	{
-		result = pwrite(fd, static_cast<const uint8_t*>(buffer) + nowCount, size - nowCount, offset + nowCount);
-		if (result > 0)
+		if (fill.patch != nullptr)
+		{
+			memcpy(fill.data + fill.patchOffset, fill.patch, fill.patchSize);
+		}
+		err = cache.write(fill.blockNumber, fill.data, false);
+		if (err != SUCCESS)
 		{
-			nowCount += static_cast<int>(result);
+			return err;
 		}
-		retries++;
 	}
-	if (nowCount != static_cast<int>(size))
+	return SUCCESS;
+}
+
+ErrorCode BlockDevice::writeBytes(uint64_t offset, const void* buffer, size_t size)
+{
+	if (isInTransaction)
 	{
-		return ERROR_WRITE_FAIL;
+		return ERROR_IS_IN_TRANSACTION;
 	}
-	return SUCCESS;
+	return writeRaw(offset, buffer, size);
+}
+
+ErrorCode BlockDevice::writeRaw(uint64_t offset, const void* buffer, size_t size)
+{
+	if (size == 0)
+	{
+		return SUCCESS;
+	}
+	return backend->write(offset, buffer, size);
+}
+
+ErrorCode BlockDevice::writeVector(uint64_t offset, const iovec *vectors, size_t count, size_t size)
+{
+	return backend->writeVector(offset, vectors, count, size);
 }
 
 ErrorCode BlockDevice::writeBlock(uint32_t blockNumber, const void* buffer)
 {
-	if (isInTransaction)
+	if (ownsTransaction())
 	{
-		transactionWrites[blockNumber] = std::vector<uint8_t>(static_cast<const uint8_t*>(buffer), static_cast<const uint8_t*>(buffer) + blockSize);
+		uint8_t *staged = transactionWrites.insert(blockNumber);
+		if (staged == nullptr)
+		{
+			return ERROR_CANNOT_ALLOCATE_MEMORY;
+		}
+		memcpy(staged, buffer, blockSize);
 		return SUCCESS;
 	}
+	if (cache.isEnabled())
+	{
+		return cache.write(blockNumber, buffer, true);
+	}
 	uint64_t offset = static_cast<uint64_t>(blockNumber) * blockSize;
-	return writeBytes(offset, buffer, blockSize);
+	return writeRaw(offset, buffer, blockSize);
 }
 
 ErrorCode BlockDevice::writeZone(uint32_t zoneNumber, const void* buffer)
 {
-	if (isInTransaction)
+	if (ownsTransaction() || cache.isEnabled())
 	{
 		for (Bno blockNumber = zoneNumber * (zoneSize / blockSize); blockNumber < (zoneNumber + 1) * (zoneSize / blockSize); blockNumber++)
 		{
@@ -166,7 +498,120 @@ ErrorCode BlockDevice::writeZone(uint32_t zoneNumber, const void* buffer)
 		return SUCCESS;
 	}
 	uint64_t offset = static_cast<uint64_t>(zoneNumber) * zoneSize;
-	return writeBytes(offset, buffer, zoneSize);
+	return writeRaw(offset, buffer, zoneSize);
+}
+
+ErrorCode BlockDevice::writeRuns(const std::vector<ZoneWriteRun> &runs)
+{
+	if (!ownsTransaction() && !cache.isEnabled())
+	{
+		for (const ZoneWriteRun &run : runs)
+		{
+			ErrorCode err = writeRaw(run.offset, run.buffer, run.size);
+			if (err != SUCCESS)
+			{
+				return err;
+			}
+		}
+		return SUCCESS;
+	}
+	static thread_local std::vector<uint8_t> blockBuffer;
+	blockBuffer.resize(blockSize);
+	for (const ZoneWriteRun &run : runs)
+	{
+		uint64_t end = run.offset + run.size;
+		uint64_t position = run.offset;
+		while (position < end)
+		{
+			Bno blockNumber = static_cast<Bno>(position / blockSize);
+			uint64_t blockStart = static_cast<uint64_t>(blockNumber) * blockSize;
+			uint32_t low = static_cast<uint32_t>(position - blockStart);
+			uint32_t high = static_cast<uint32_t>(std::min<uint64_t>(blockSize, end - blockStart));
+			const uint8_t *source = run.buffer + (position - run.offset);
+			position = blockStart + high;
+			if (high - low == blockSize)
+			{
+				ErrorCode err = writeBlock(blockNumber, source);
+				if (err != SUCCESS)
+				{
+					return err;
+				}
+				continue;
+			}
+			ErrorCode err = readBlock(blockNumber, blockBuffer.data());
+			if (err != SUCCESS)
+			{
+				return err;
+			}
+			memcpy(blockBuffer.data() + low, source, high - low);
+			err = writeBlock(blockNumber, blockBuffer.data());
+			if (err != SUCCESS)
+			{
+				return err;
+			}
+		}
+	}
+	return SUCCESS;
+}
+
+ErrorCode BlockDevice::writeRunsInPlace(const std::vector<ZoneWriteRun> &runs)
+{
+	if (journal.isEnabled())
+	{
+		bool journaled = false;
+		for (size_t r = 0; r < runs.size() && !journaled; r++)
+		{
+			journaled = journal.contains(static_cast<Bno>(runs[r].offset / blockSize), static_cast<Bno>((runs[r].offset + runs[r].size + blockSize - 1) / blockSize));
+		}
+		if (journaled)
+		{
+			ErrorCode err = checkpoint();
+			if (err != SUCCESS)
+			{
+				return err;
+			}
+		}
+	}
+	static thread_local std::vector<iovec> vectors;
+	vectors.clear();
+	uint64_t runOffset = 0;
+	size_t runSize = 0;
+	for (const ZoneWriteRun &run : runs)
+	{
+		for (Bno blockNumber = static_cast<Bno>(run.offset / blockSize); static_cast<uint64_t>(blockNumber) * blockSize < run.offset + run.size; blockNumber++)
+		{
+			cache.invalidate(blockNumber);
+		}
+		if (runSize > 0 && (run.offset != runOffset + runSize || vectors.size() == VECTORED_IO_MAX_SEGMENTS))
+		{
+			ErrorCode err = writeVector(runOffset, vectors.data(), vectors.size(), runSize);
+			if (err != SUCCESS)
+			{
+				return err;
+			}
+			vectors.clear();
+			runSize = 0;
+		}
+		if (runSize == 0)
+		{
+			runOffset = run.offset;
+		}
+		vectors.push_back(iovec{const_cast<uint8_t*>(run.buffer), run.size});
+		runSize += run.size;
+	}
+	if (runSize > 0)
+	{
+		ErrorCode err = writeVector(runOffset, vectors.data(), vectors.size(), runSize);
+		if (err != SUCCESS)
+		{
+			return err;
+		}
+	}
+	if (!runs.empty())
+	{
+		journal.markInPlaceData();
+	}
+	return SUCCESS;
 }
 
 ErrorCode BlockDevice::fdatasync()
@@ -175,11 +620,17 @@ ErrorCode BlockDevice::fdatasync()
 	{
 		return ERROR_IS_IN_TRANSACTION;
 	}
-	if (::fdatasync(fd) < 0)
+	ErrorCode err = cache.flush();
+	if (err != SUCCESS)
 	{
-		return ERROR_WRITE_FAIL;
+		return err;
 	}
-	return SUCCESS;
+	err = backend->sync(true);
+	if (err != SUCCESS)
+	{
+		return err;
+	}
+	return journal.reset();
 }
 
 ErrorCode BlockDevice::fsync()
@@ -188,11 +639,17 @@ ErrorCode BlockDevice::fsync()
 	{
 		return ERROR_IS_IN_TRANSACTION;
 	}
-	if (::fsync(fd) < 0)
+	ErrorCode err = cache.flush();
+	if (err != SUCCESS)
 	{
-		return ERROR_WRITE_FAIL;
+		return err;
 	}
-	return SUCCESS;
+	err = backend->sync(false);
+	if (err != SUCCESS)
+	{
+		return err;
+	}
+	return journal.reset();
 }
 
 ErrorCode BlockDevice::beginTransaction()
@@ -201,8 +658,9 @@ ErrorCode BlockDevice::beginTransaction()
 	{
 		return ERROR_IS_IN_TRANSACTION;
 	}
-	isInTransaction = true;
 	transactionWrites.clear();
+	transactionOwner = std::this_thread::get_id();
+	isInTransaction = true;
 	return SUCCESS;
 }
 
@@ -214,6 +672,10 @@ ErrorCode BlockDevice::revertTransaction()
 	}
 	transactionWrites.clear();
 	isInTransaction = false;
+	if (journal.isEnabled() && journal.size() >= JOURNAL_CHECKPOINT_BYTES)
+	{
+		return checkpoint();
+	}
 	return SUCCESS;
 }
 
@@ -224,33 +686,77 @@ ErrorCode BlockDevice::commitTransaction()
 		return ERROR_FS_BROKEN;
 	}
 	isInTransaction = false;
-	static uint8_t writeBuffer[ONETIME_MAX_WRITE_SIZE];
-	uint32_t bufferOffset = 0;
-	Bno startBlock = std::numeric_limits<Bno>::max();
-	Bno lstBlock = startBlock;
-	for (const auto& [blockNumber, data] : transactionWrites)
+	bool cached = cache.isEnabled() && transactionWrites.size() <= cache.getCapacity() / 2;
+	if (journal.isEnabled())
+	{
+		ErrorCode err = journal.append(transactionWrites, blockSize);
+		if (err == SUCCESS && (!cached || journal.pendingBytes() >= JOURNAL_GROUP_COMMIT_BYTES))
+		{
+			err = journal.flush(*backend);
+		}
+		if (err != SUCCESS)
+		{
+			isInTransaction = true;
+			return err;
+		}
+	}
+	if (cached)
 	{
-		if (bufferOffset + blockSize > ONETIME_MAX_WRITE_SIZE || blockNumber != lstBlock + 1)
+		for (uint32_t slot = 0; slot < transactionWrites.size(); slot++)
 		{
-			if (bufferOffset > 0)
+			ErrorCode err = cache.write(transactionWrites.blockAt(slot), transactionWrites.dataAt(slot), true);
+			if (err != SUCCESS)
 			{
-				ErrorCode err = writeBytes(static_cast<uint64_t>(startBlock) * blockSize, writeBuffer, bufferOffset);
-				if (err != SUCCESS)
-				{
-					isInTransaction = true;
-					return err;
-				}
+				isInTransaction = true;
+				return err;
 			}
-			bufferOffset = 0;
-			startBlock = blockNumber;
 		}
-		std::memcpy(writeBuffer + bufferOffset, data.data(), blockSize);
-		bufferOffset += blockSize;
+		transactionWrites.clear();
+		if (journal.isEnabled() && journal.size() >= JOURNAL_CHECKPOINT_BYTES)
+		{
+			return checkpoint();
+		}
+		return SUCCESS;
+	}
+	static thread_local std::vector<iovec> vectors;
+	vectors.clear();
+	uint64_t runOffset = 0;
+	size_t runSize = 0;
+	Bno lstBlock = std::numeric_limits<Bno>::max();
+	for (uint32_t slot : transactionWrites.sortedSlots())
+	{
+		Bno blockNumber = transactionWrites.blockAt(slot);
+		uint8_t *data = transactionWrites.dataAt(slot);
+		if (runSize > 0 && (blockNumber != lstBlock + 1 || runSize + blockSize > ONETIME_MAX_WRITE_SIZE || vectors.size() == VECTORED_IO_MAX_SEGMENTS))
+		{
+			ErrorCode err = writeVector(runOffset, vectors.data(), vectors.size(), runSize);
+			if (err != SUCCESS)
+			{
+				isInTransaction = true;
+				return err;
+			}
+			vectors.clear();
+			runSize = 0;
+		}
+		if (runSize == 0)
+		{
+			runOffset = static_cast<uint64_t>(blockNumber) * blockSize;
+		}
+		if (!vectors.empty() && static_cast<uint8_t*>(vectors.back().iov_base) + vectors.back().iov_len == data)
+		{
+			vectors.back().iov_len += blockSize;
+		}
+		else
+		{
+			vectors.push_back(iovec{data, blockSize});
+		}
+		cache.updateIfPresent(blockNumber, data);
+		runSize += blockSize;
 		lstBlock = blockNumber;
 	}
-	if (bufferOffset > 0)
+	if (runSize > 0)
 	{
-		ErrorCode err = writeBytes(static_cast<uint64_t>(startBlock) * blockSize, writeBuffer, bufferOffset);
+		ErrorCode err = writeVector(runOffset, vectors.data(), vectors.size(), runSize);
 		if (err != SUCCESS)
 		{
 			isInTransaction = true;
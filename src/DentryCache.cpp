@@ -0,0 +1,177 @@
+#include "DentryCache.h"
+
+void DentryCache::setCapacity(uint32_t capacity)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	this->capacity = capacity;
+	evict();
+}
+
+bool DentryCache::lookup(Ino parentInodeNumber, const std::string &name, Ino &outInodeNumber, uint32_t &outEntryIndex)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	auto dirIt = directories.find(parentInodeNumber);
+	if (dirIt == directories.end())
+	{
+		return false;
+	}
+	auto it = dirIt->second.find(name);
+	if (it == dirIt->second.end())
+	{
+		return false;
+	}
+	lru.splice(lru.begin(), lru, it->second.lruPosition);
+	outInodeNumber = it->second.inodeNumber;
+	outEntryIndex = it->second.entryIndex;
+	return true;
+}
+
+void DentryCache::insert(Ino parentInodeNumber, const std::string &name, Ino inodeNumber, uint32_t entryIndex)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (capacity == 0)
+	{
+		return;
+	}
+	if (isInTransaction && (transactionDirtyDirectories.count(parentInodeNumber) != 0 || transactionDirtyNames.count({parentInodeNumber, name}) != 0))
+	{
+		return;
+	}
+	std::unordered_map<std::string, DentryCacheEntry> &entries = directories[parentInodeNumber];
+	auto it = entries.find(name);
+	if (it != entries.end())
+	{
+		it->second.inodeNumber = inodeNumber;
+		it->second.entryIndex = entryIndex;
+		lru.splice(lru.begin(), lru, it->second.lruPosition);
+		return;
+	}
+	lru.emplace_front(parentInodeNumber, name);
+	entries.emplace(name, DentryCacheEntry{inodeNumber, entryIndex, lru.begin()});
+	size++;
+	evict();
+}
+
+void DentryCache::invalidate(Ino parentInodeNumber, const std::string &name)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (isInTransaction)
+	{
+		transactionDirtyNames.emplace(parentInodeNumber, name);
+	}
+	erase(parentInodeNumber, name);
+}
+
+void DentryCache::invalidateDirectory(Ino dirInodeNumber)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (isInTransaction)
+	{
+		transactionDirtyDirectories.insert(dirInodeNumber);
+	}
+	eraseDirectory(dirInodeNumber);
+}
+
+void DentryCache::erase(Ino parentInodeNumber, const std::string &name)
+{
+	auto dirIt = directories.find(parentInodeNumber);
+	if (dirIt == directories.end())
+	{
+		return;
+	}
+	auto it = dirIt->second.find(name);
+	if (it == dirIt->second.end())
+	{
+		return;
+	}
+	lru.erase(it->second.lruPosition);
+	dirIt->second.erase(it);
+	size--;
+	if (dirIt->second.empty())
+	{
+		directories.erase(dirIt);
+	}
+}
+
+void DentryCache::eraseDirectory(Ino dirInodeNumber)
+{
+	auto dirIt = directories.find(dirInodeNumber);
+	if (dirIt == directories.end())
+	{
+		return;
+	}
+	for (auto &[name, entry] : dirIt->second)
+	{
+		lru.erase(entry.lruPosition);
+		size--;
+	}
+	directories.erase(dirIt);
+}
+
+void DentryCache::evict()
+{
+	while (size > capacity && !lru.empty())
+	{
+		std::pair<Ino, std::string> victim = lru.back();
+		erase(victim.first, victim.second);
+	}
+}
+
+void DentryCache::dropTransactionDirty()
+{
+	for (const auto &[parentInodeNumber, name] : transactionDirtyNames)
+	{
+		erase(parentInodeNumber, name);
+	}
+	for (Ino dirInodeNumber : transactionDirtyDirectories)
+	{
+		eraseDirectory(dirInodeNumber);
+	}
+	transactionDirtyNames.clear();
+	transactionDirtyDirectories.clear();
+}
+
+ErrorCode DentryCache::beginTransaction()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (isInTransaction)
+	{
+		return ERROR_IS_IN_TRANSACTION;
+	}
+	isInTransaction = true;
+	return SUCCESS;
+}
+
+ErrorCode DentryCache::revertTransaction()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (!isInTransaction)
+	{
+		return ERROR_FS_BROKEN;
+	}
+	dropTransactionDirty();
+	isInTransaction = false;
+	return SUCCESS;
+}
+
+ErrorCode DentryCache::commitTransaction()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (!isInTransaction)
+	{
+		return ERROR_FS_BROKEN;
+	}
+	dropTransactionDirty();
+	isInTransaction = false;
+	return SUCCESS;
+}
+
+void DentryCache::clear()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	directories.clear();
+	lru.clear();
+	size = 0;
+	transactionDirtyNames.clear();
+	transactionDirtyDirectories.clear();
+}
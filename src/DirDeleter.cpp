@@ -25,6 +25,16 @@ void DirDeleter::setPathResolver(PathResolver &pathResolver)
 	this->pathResolver = &pathResolver;
 }
 
+void DirDeleter::setDentryCache(DentryCache &dentryCache)
+{
+	this->dentryCache = &dentryCache;
+}
+
+void DirDeleter::setDirIndex(DirIndex &dirIndex)
+{
+	this->dirIndex = &dirIndex;
+}
+
 ErrorCode DirDeleter::deleteDir(Ino parentInodeNumber, const std::string &dirName)
 {
 	ErrorCode err;
@@ -86,5 +96,7 @@ ErrorCode DirDeleter::deleteDir(Ino parentInodeNumber, const std::string &dirNam
 	{
 		return err;
 	}
+	dentryCache->invalidateDirectory(dirInodeNumber);
+	dirIndex->invalidate(dirInodeNumber);
 	return SUCCESS;
 }
\ No newline at end of file
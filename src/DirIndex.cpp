@@ -0,0 +1,431 @@
+#include "DirIndex.h"
+#include "DirEntry.h"
+#include "Inode.h"
+#include "Utils.h"
+#include <algorithm>
+#include <iterator>
+#include <limits>
+
+static uint32_t applyWrite(DirIndexDirectory &directory, uint32_t slot, Ino entryInodeNumber, const std::string &entryName)
+{
+	uint32_t addedSlots = 0;
+	if (slot >= directory.slotCount)
+	{
+		for (uint32_t newSlot = directory.slotCount; newSlot < slot; newSlot++)
+		{
+			directory.freeSlots.insert(newSlot);
+		}
+		addedSlots = slot + 1 - directory.slotCount;
+		directory.slotCount = slot + 1;
+	}
+	directory.freeSlots.erase(slot);
+	directory.entryOfName[entryName] = DirIndexEntry{slot, entryInodeNumber};
+	return addedSlots;
+}
+
+static void applyRemove(DirIndexDirectory &directory, uint32_t slot, const std::string &oldEntryName)
+{
+	auto entryIt = directory.entryOfName.find(oldEntryName);
+	if (entryIt != directory.entryOfName.end() && entryIt->second.slot == slot)
+	{
+		directory.entryOfName.erase(entryIt);
+	}
+	directory.freeSlots.insert(slot);
+}
+
+void DirIndex::setInodeReader(InodeReader &inodeReader)
+{
+	this->inodeReader = &inodeReader;
+}
+
+void DirIndex::setDirReader(DirReader &dirReader)
+{
+	this->dirReader = &dirReader;
+}
+
+void DirIndex::setCapacity(uint32_t capacity)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	this->capacity = capacity;
+	evict();
+}
+
+bool DirIndex::ownsTransaction() const
+{
+	return isInTransaction && transactionOwner == std::this_thread::get_id();
+}
+
+ErrorCode DirIndex::build(Ino dirInodeNumber, DirIndexDirectory &directory)
+{
+	MinixInode3 dirInode;
+	ErrorCode err = inodeReader->readInode(dirInodeNumber, &dirInode);
+	if (err != SUCCESS)
+	{
+		return err;
+	}
+	directory.slotCount = 0;
+	err = dirReader->iterateDir(dirInode, 0, std::numeric_limits<uint32_t>::max(), [&](uint32_t slot, const DirEntryOnDisk &entry)
+	{
+		directory.slotCount = slot + 1;
+		if (entry.d_inode == 0)
+		{
+			directory.freeSlots.insert(slot);
+			return true;
+		}
+		directory.entryOfName.emplace(char60ToString(entry.d_name), DirIndexEntry{slot, entry.d_inode});
+		return true;
+	});
+	return err;
+}
+
+DirIndexDirectory *DirIndex::get(Ino dirInodeNumber, std::unique_lock<std::mutex> &lock, DirIndexTransactionDirectory *&outChanges, ErrorCode &outError)
+{
+	outChanges = nullptr;
+	bool transactional = ownsTransaction();
+	if (transactional)
+	{
+		auto txIt = transactionDirectories.find(dirInodeNumber);
+		if (txIt != transactionDirectories.end())
+		{
+			outError = SUCCESS;
+			if (txIt->second.replacesCommitted)
+			{
+				return &txIt->second.directory;
+			}
+			outChanges = &txIt->second;
+			return &directories.find(dirInodeNumber)->second;
+		}
+	}
+	bool isPrivate = transactional && transactionDirtyDirectories.count(dirInodeNumber) != 0;
+	if (!isPrivate)
+	{
+		auto it = directories.find(dirInodeNumber);
+		if (it != directories.end())
+		{
+			lru.splice(lru.begin(), lru, it->second.lruPosition);
+			outError = SUCCESS;
+			return &it->second;
+		}
+	}
+	DirIndexDirectory directory;
+	lock.unlock();
+	outError = build(dirInodeNumber, directory);
+	lock.lock();
+	if (outError != SUCCESS)
+	{
+		return nullptr;
+	}
+	if (isPrivate)
+	{
+		DirIndexTransactionDirectory &changes = transactionDirectories[dirInodeNumber];
+		changes.replacesCommitted = true;
+		changes.directory = std::move(directory);
+		return &changes.directory;
+	}
+	auto it = directories.find(dirInodeNumber);
+	if (it != directories.end())
+	{
+		return &it->second;
+	}
+	store(dirInodeNumber, std::move(directory));
+	evict();
+	return &directories.find(dirInodeNumber)->second;
+}
+
+DirIndexTransactionDirectory *DirIndex::getChanges(Ino dirInodeNumber)
+{
+	bool wasDirty = !transactionDirtyDirectories.insert(dirInodeNumber).second;
+	auto txIt = transactionDirectories.find(dirInodeNumber);
+	if (txIt != transactionDirectories.end())
+	{
+		return &txIt->second;
+	}
+	if (wasDirty)
+	{
+		return nullptr;
+	}
+	auto it = directories.find(dirInodeNumber);
+	if (it == directories.end())
+	{
+		return nullptr;
+	}
+	DirIndexTransactionDirectory &changes = transactionDirectories[dirInodeNumber];
+	changes.replacesCommitted = false;
+	changes.directory.slotCount = it->second.slotCount;
+	return &changes;
+}
+
+bool DirIndex::findName(DirIndexDirectory &directory, DirIndexTransactionDirectory *changes, const std::string &name, DirIndexEntry &outEntry)
+{
+	if (changes != nullptr)
+	{
+		auto it = changes->directory.entryOfName.find(name);
+		if (it != changes->directory.entryOfName.end())
+		{
+			outEntry = it->second;
+			return outEntry.inodeNumber != 0;
+		}
+	}
+	auto it = directory.entryOfName.find(name);
+	if (it == directory.entryOfName.end())
+	{
+		return false;
+	}
+	outEntry = it->second;
+	return true;
+}
+
+ErrorCode DirIndex::find(Ino dirInodeNumber, const std::string &name, DirIndexEntry &outEntry)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	ErrorCode err;
+	DirIndexTransactionDirectory *changes;
+	DirIndexDirectory *directory = get(dirInodeNumber, lock, changes, err);
+	if (directory == nullptr)
+	{
+		return err;
+	}
+	if (!findName(*directory, changes, name, outEntry))
+	{
+		return ERROR_FILE_NOT_FOUND;
+	}
+	return SUCCESS;
+}
+
+ErrorCode DirIndex::findFreeSlot(Ino dirInodeNumber, const std::string &name, bool &outFound, uint32_t &outSlot)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	ErrorCode err;
+	DirIndexTransactionDirectory *changes;
+	DirIndexDirectory *directory = get(dirInodeNumber, lock, changes, err);
+	if (directory == nullptr)
+	{
+		return err;
+	}
+	DirIndexEntry existingEntry;
+	if (findName(*directory, changes, name, existingEntry))
+	{
+		return ERROR_FILE_NAME_EXISTS;
+	}
+	outFound = false;
+	if (changes != nullptr && !changes->directory.freeSlots.empty())
+	{
+		outSlot = *changes->directory.freeSlots.begin();
+		outFound = true;
+	}
+	for (uint32_t slot : directory->freeSlots)
+	{
+		if (changes != nullptr && changes->usedSlots.count(slot) != 0)
+		{
+			continue;
+		}
+		if (!outFound || slot < outSlot)
+		{
+			outSlot = slot;
+			outFound = true;
+		}
+		break;
+	}
+	return SUCCESS;
+}
+
+void DirIndex::noteWrite(Ino dirInodeNumber, uint32_t slot, Ino entryInodeNumber, const std::string &entryName)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (!ownsTransaction())
+	{
+		auto it = directories.find(dirInodeNumber);
+		if (it != directories.end())
+		{
+			size += applyWrite(it->second, slot, entryInodeNumber, entryName);
+		}
+		return;
+	}
+	DirIndexTransactionDirectory *changes = getChanges(dirInodeNumber);
+	if (changes == nullptr)
+	{
+		return;
+	}
+	if (changes->replacesCommitted)
+	{
+		applyWrite(changes->directory, slot, entryInodeNumber, entryName);
+		return;
+	}
+	DirIndexDirectory &delta = changes->directory;
+	for (uint32_t newSlot = delta.slotCount; newSlot < slot; newSlot++)
+	{
+		delta.freeSlots.insert(newSlot);
+	}
+	delta.slotCount = std::max(delta.slotCount, slot + 1);
+	delta.freeSlots.erase(slot);
+	changes->usedSlots.insert(slot);
+	delta.entryOfName[entryName] = DirIndexEntry{slot, entryInodeNumber};
+}
+
+void DirIndex::noteRemove(Ino dirInodeNumber, uint32_t slot, const std::string &oldEntryName)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (!ownsTransaction())
+	{
+		auto it = directories.find(dirInodeNumber);
+		if (it != directories.end())
+		{
+			applyRemove(it->second, slot, oldEntryName);
+		}
+		return;
+	}
+	DirIndexTransactionDirectory *changes = getChanges(dirInodeNumber);
+	if (changes == nullptr)
+	{
+		return;
+	}
+	if (changes->replacesCommitted)
+	{
+		applyRemove(changes->directory, slot, oldEntryName);
+		return;
+	}
+	DirIndexEntry oldEntry;
+	if (findName(directories.find(dirInodeNumber)->second, changes, oldEntryName, oldEntry) && oldEntry.slot == slot)
+	{
+		changes->directory.entryOfName[oldEntryName] = DirIndexEntry{slot, 0};
+	}
+	changes->directory.freeSlots.insert(slot);
+	changes->usedSlots.erase(slot);
+}
+
+void DirIndex::invalidate(Ino dirInodeNumber)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (ownsTransaction())
+	{
+		transactionDirtyDirectories.insert(dirInodeNumber);
+		transactionDirectories.erase(dirInodeNumber);
+		return;
+	}
+	erase(dirInodeNumber);
+}
+
+void DirIndex::store(Ino dirInodeNumber, DirIndexDirectory &&directory)
+{
+	lru.push_front(dirInodeNumber);
+	directory.lruPosition = lru.begin();
+	size += directory.slotCount;
+	directories.emplace(dirInodeNumber, std::move(directory));
+}
+
+void DirIndex::erase(Ino dirInodeNumber)
+{
+	auto it = directories.find(dirInodeNumber);
+	if (it == directories.end())
+	{
+		return;
+	}
+	size -= it->second.slotCount;
+	lru.erase(it->second.lruPosition);
+	directories.erase(it);
+}
+
+void DirIndex::evict()
+{
+	auto it = lru.end();
+	while (size > capacity && it != lru.begin() && std::prev(it) != lru.begin())
+	{
+		--it;
+		if (transactionDirectories.count(*it) != 0)
+		{
+			continue;
+		}
+		Ino victim = *it++;
+		erase(victim);
+	}
+}
+
+ErrorCode DirIndex::beginTransaction()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (isInTransaction)
+	{
+		return ERROR_IS_IN_TRANSACTION;
+	}
+	transactionOwner = std::this_thread::get_id();
+	isInTransaction = true;
+	return SUCCESS;
+}
+
+ErrorCode DirIndex::revertTransaction()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (!isInTransaction)
+	{
+		return ERROR_FS_BROKEN;
+	}
+	transactionDirectories.clear();
+	transactionDirtyDirectories.clear();
+	isInTransaction = false;
+	evict();
+	return SUCCESS;
+}
+
+ErrorCode DirIndex::commitTransaction()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (!isInTransaction)
+	{
+		return ERROR_FS_BROKEN;
+	}
+	for (Ino dirInodeNumber : transactionDirtyDirectories)
+	{
+		auto txIt = transactionDirectories.find(dirInodeNumber);
+		if (txIt == transactionDirectories.end())
+		{
+			erase(dirInodeNumber);
+			continue;
+		}
+		if (txIt->second.replacesCommitted)
+		{
+			erase(dirInodeNumber);
+			store(dirInodeNumber, std::move(txIt->second.directory));
+			continue;
+		}
+		auto it = directories.find(dirInodeNumber);
+		if (it == directories.end())
+		{
+			continue;
+		}
+		DirIndexDirectory &directory = it->second;
+		const DirIndexDirectory &delta = txIt->second.directory;
+		for (const auto &[name, entry] : delta.entryOfName)
+		{
+			if (entry.inodeNumber == 0)
+			{
+				directory.entryOfName.erase(name);
+			}
+			else
+			{
+				directory.entryOfName[name] = entry;
+			}
+		}
+		for (uint32_t slot : txIt->second.usedSlots)
+		{
+			directory.freeSlots.erase(slot);
+		}
+		directory.freeSlots.insert(delta.freeSlots.begin(), delta.freeSlots.end());
+		size += delta.slotCount - directory.slotCount;
+		directory.slotCount = delta.slotCount;
+	}
+	transactionDirectories.clear();
+	transactionDirtyDirectories.clear();
+	isInTransaction = false;
+	evict();
+	return SUCCESS;
+}
+
+void DirIndex::clear()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	directories.clear();
+	lru.clear();
+	size = 0;
+	transactionDirectories.clear();
+	transactionDirtyDirectories.clear();
+}
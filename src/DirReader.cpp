@@ -1,6 +1,8 @@
 #include "DirReader.h"
 #include "Inode.h"
 #include <cstring>
+#include <algorithm>
+#include <limits>
 #include "Utils.h"
 
 void DirReader::setInodeReader(InodeReader &inodeReader)
@@ -33,123 +35,126 @@ ErrorCode DirReader::readDirRaw(Ino dirInodeNumber, uint8_t *buffer, uint32_t si
 	return readDirRaw(dirInode, buffer, sizeToRead, offset);
 }
 
-std::vector<DirEntry> DirReader::readDir(Ino dirInodeNumber, uint32_t offset, uint32_t count, ErrorCode &outError, bool keepInode0Entries)
+ErrorCode DirReader::iterateDir(MinixInode3 &dirInode, uint32_t offset, uint32_t count, const std::function<bool(uint32_t entryIndex, const DirEntryOnDisk &entry)> &visitor)
 {
-	std::vector<DirEntry> entries;
-	MinixInode3 dirInode;
-	ErrorCode err = inodeReader->readInode(dirInodeNumber, &dirInode);
-	if (err != SUCCESS)
-	{
-		outError = err;
-		return entries;
-	}
 	if (!dirInode.isDirectory())
 	{
-		outError = ERROR_NOT_DIRECTORY;
-		return entries;
+		return ERROR_NOT_DIRECTORY;
 	}
 	uint32_t dirSize = dirInode.i_size;
 	if (dirSize % sizeof(DirEntryOnDisk) != 0)
 	{
-		outError = ERROR_FS_BROKEN;
-		return entries;
+		return ERROR_FS_BROKEN;
 	}
 	uint32_t totalEntries = dirSize / sizeof(DirEntryOnDisk);
 	if (offset >= totalEntries)
 	{
-		outError = SUCCESS;
-		return entries;
+		return SUCCESS;
 	}
-	uint32_t entriesToRead = std::min(count, totalEntries - offset);
-	uint8_t *dirData = static_cast<uint8_t*>(malloc(entriesToRead * sizeof(DirEntryOnDisk)));
-	if (dirData == nullptr)
+	uint32_t endEntry = offset + std::min(count, totalEntries - offset);
+	DirEntryOnDisk chunk[DIR_ITERATE_CHUNK_ENTRIES];
+	for (uint32_t chunkStart = offset; chunkStart < endEntry; chunkStart += DIR_ITERATE_CHUNK_ENTRIES)
 	{
-		outError = ERROR_CANNOT_ALLOCATE_MEMORY;
-		return entries;
+		uint32_t chunkEntries = std::min<uint32_t>(DIR_ITERATE_CHUNK_ENTRIES, endEntry - chunkStart);
+		ErrorCode err = readDirRaw(dirInode, reinterpret_cast<uint8_t*>(chunk), chunkEntries * sizeof(DirEntryOnDisk), chunkStart * sizeof(DirEntryOnDisk));
+		if (err != SUCCESS)
+		{
+			return err;
+		}
+		for (uint32_t i = 0; i < chunkEntries; i++)
+		{
+			if (!visitor(chunkStart + i, chunk[i]))
+			{
+				return SUCCESS;
+			}
+		}
 	}
-	err = readDirRaw(dirInode, dirData, entriesToRead * sizeof(DirEntryOnDisk), offset * sizeof(DirEntryOnDisk));
+	return SUCCESS;
+}
+
+ErrorCode DirReader::iterateDir(Ino dirInodeNumber, uint32_t offset, uint32_t count, const std::function<bool(uint32_t entryIndex, const DirEntryOnDisk &entry)> &visitor)
+{
+	MinixInode3 dirInode;
+	ErrorCode err = inodeReader->readInode(dirInodeNumber, &dirInode);
 	if (err != SUCCESS)
 	{
-		outError = err;
-		free(dirData);
-		return entries;
+		return err;
 	}
-	for (uint32_t offset = 0; offset < entriesToRead * sizeof(DirEntryOnDisk); offset += sizeof(DirEntryOnDisk))
+	return iterateDir(dirInode, offset, count, visitor);
+}
+
+std::vector<DirEntry> DirReader::readDir(Ino dirInodeNumber, uint32_t offset, uint32_t count, ErrorCode &outError, bool keepInode0Entries, bool withStat)
+{
+	std::vector<DirEntry> entries;
+	ErrorCode err = iterateDir(dirInodeNumber, offset, count, [&](uint32_t entryIndex, const DirEntryOnDisk &entryOnDisk)
 	{
-		DirEntryOnDisk *entryOnDisk = reinterpret_cast<DirEntryOnDisk*>(dirData + offset);
-		if (keepInode0Entries || entryOnDisk->d_inode != 0)
+		if (keepInode0Entries || entryOnDisk.d_inode != 0)
 		{
 			DirEntry entry;
-			entry.raw = *entryOnDisk;
-			memcpy(entry.raw.d_name, entryOnDisk->d_name, MINIX3_DIR_NAME_MAX);
-			if (entry.raw.d_inode == 0)
-			{
-				entry.st = {};
-				entries.push_back(entry);
-				continue;
-			}
-			MinixInode3 entryInode;
-			err = inodeReader->readInode(entryOnDisk->d_inode, &entryInode);
-			if (err != SUCCESS)
+			entry.raw = entryOnDisk;
+			entry.st = {};
+			entry.index = entryIndex;
+			entries.push_back(entry);
+		}
+		return true;
+	});
+	if (err != SUCCESS)
+	{
+		outError = err;
+		return {};
+	}
+	if (withStat)
+	{
+		std::vector<Ino> inodeNumbers;
+		for (const DirEntry &entry : entries)
+		{
+			if (entry.raw.d_inode != 0)
 			{
-				free(dirData);
-				outError = err;
-				return entries;
+				inodeNumbers.push_back(entry.raw.d_inode);
 			}
-			entry.st = inodeReader->readStat(entryOnDisk->d_inode, err);
-			if (err != SUCCESS)
+		}
+		std::vector<struct stat> stats;
+		err = inodeReader->readStats(inodeNumbers, stats);
+		if (err != SUCCESS)
+		{
+			outError = err;
+			return {};
+		}
+		size_t statIndex = 0;
+		for (DirEntry &entry : entries)
+		{
+			if (entry.raw.d_inode != 0)
 			{
-				free(dirData);
-				outError = err;
-				return entries;
+				entry.st = stats[statIndex++];
 			}
-			entries.push_back(entry);
 		}
 	}
-	free(dirData);
 	outError = SUCCESS;
 	return entries;
 }
 
 bool DirReader::isDirEmpty(Ino dirInodeNumber, ErrorCode &outError)
 {
-	MinixInode3 dirInode;
-	ErrorCode err = inodeReader->readInode(dirInodeNumber, &dirInode);
-	if (err != SUCCESS)
-	{
-		outError = err;
-		return false;
-	}
-	if (!dirInode.isDirectory())
+	bool isEmpty = true;
+	ErrorCode err = iterateDir(dirInodeNumber, 0, std::numeric_limits<uint32_t>::max(), [&](uint32_t, const DirEntryOnDisk &entry)
 	{
-		outError = ERROR_NOT_DIRECTORY;
-		return false;
-	}
-	uint32_t dirSize = dirInode.i_size;
-	if (dirSize % sizeof(DirEntryOnDisk) != 0)
-	{
-		outError = ERROR_FS_BROKEN;
-		return false;
-	}
-	uint32_t totalEntries = dirSize / sizeof(DirEntryOnDisk);
-	std::vector<DirEntry> entries = readDir(dirInodeNumber, 0, totalEntries, err, true);
+		if (entry.d_inode == 0)
+		{
+			return true;
+		}
+		std::string name = char60ToString(entry.d_name);
+		if (name != "." && name != "..")
+		{
+			isEmpty = false;
+			return false;
+		}
+		return true;
+	});
 	if (err != SUCCESS)
 	{
 		outError = err;
 		return false;
 	}
-	for (const DirEntry &entry : entries)
-	{
-		if (entry.raw.d_inode != 0)
-		{
-			std::string name = char60ToString(entry.raw.d_name);
-			if (name != "." && name != "..")
-			{
-				outError = SUCCESS;
-				return false;
-			}
-		}
-	}
 	outError = SUCCESS;
-	return true;
+	return isEmpty;
 }
\ No newline at end of file
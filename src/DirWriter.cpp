@@ -23,6 +23,16 @@ void DirWriter::setInodeWriter(InodeWriter &inodeWriter)
 	this->inodeWriter = &inodeWriter;
 }
 
+void DirWriter::setDentryCache(DentryCache &dentryCache)
+{
+	this->dentryCache = &dentryCache;
+}
+
+void DirWriter::setDirIndex(DirIndex &dirIndex)
+{
+	this->dirIndex = &dirIndex;
+}
+
 ErrorCode DirWriter::addDirEntry(Ino dirInodeNumber, Ino entryInodeNumber, const std::string &entryName, uint32_t &outEntryIndex)
 {
 	MinixInode3 dirInode;
@@ -43,45 +53,46 @@ ErrorCode DirWriter::addDirEntry(Ino dirInodeNumber, Ino entryInodeNumber, const
 	{
 		return ERROR_INVALID_INODE_NUMBER;
 	}
-	uint32_t dirSize = dirInode.i_size;
-	uint32_t totalEntries = dirSize / sizeof(DirEntryOnDisk);
-	std::vector<DirEntry> entries = dirReader->readDir(dirInodeNumber, 0, totalEntries, err, true);
+	bool hasFreeSlot;
+	err = dirIndex->findFreeSlot(dirInodeNumber, entryName, hasFreeSlot, outEntryIndex);
 	if (err != SUCCESS)
 	{
 		return err;
 	}
-	for(uint32_t i = 0; i < entries.size(); i++)
+	if (hasFreeSlot)
 	{
-		if (entries[i].raw.d_inode != 0)
-		{
-			std::string existingEntryName = char60ToString(entries[i].raw.d_name);
-			if (existingEntryName == entryName)
-			{
-				return ERROR_FILE_NAME_EXISTS;
-			}
-		}
-	}
-	for (uint32_t i = 0; i < entries.size(); i++)
-	{
-		if (entries[i].raw.d_inode == 0)
-		{
-			outEntryIndex = i;
-			return writeDirEntry(dirInodeNumber, i, entryInodeNumber, entryName);
-		}
+		return writeDirEntry(dirInodeNumber, outEntryIndex, entryInodeNumber, entryName);
 	}
+	outEntryIndex = dirInode.i_size / sizeof(DirEntryOnDisk);
 	dirInode.i_size += sizeof(DirEntryOnDisk);
 	err = inodeWriter->writeInode(dirInodeNumber, &dirInode);
 	if (err != SUCCESS)
 	{
 		return err;
 	}
-	outEntryIndex = entries.size();
 	return writeDirEntry(dirInodeNumber, outEntryIndex, entryInodeNumber, entryName);
 }
 
 ErrorCode DirWriter::removeDirEntry(Ino dirInodeNumber, uint32_t entryIndex)
 {
-	return writeDirEntry(dirInodeNumber, entryIndex, 0, "removed");
+	DirEntryOnDisk oldEntry;
+	ErrorCode err = dirReader->readDirRaw(dirInodeNumber, reinterpret_cast<uint8_t*>(&oldEntry), sizeof(DirEntryOnDisk), entryIndex * sizeof(DirEntryOnDisk));
+	if (err != SUCCESS)
+	{
+		return err;
+	}
+	std::string oldEntryName = char60ToString(oldEntry.d_name);
+	if (oldEntry.d_inode != 0)
+	{
+		dentryCache->invalidate(dirInodeNumber, oldEntryName);
+	}
+	err = writeDirEntry(dirInodeNumber, entryIndex, 0, "removed");
+	if (err != SUCCESS)
+	{
+		return err;
+	}
+	dirIndex->noteRemove(dirInodeNumber, entryIndex, oldEntryName);
+	return SUCCESS;
 }
 
 ErrorCode DirWriter::writeDirEntry(Ino dirInodeNumber, uint32_t entryIndex, Ino entryInodeNumber, const std::string &entryName)
@@ -108,5 +119,18 @@ ErrorCode DirWriter::writeDirEntry(Ino dirInodeNumber, uint32_t entryIndex, Ino
 	entryOnDisk.d_inode = entryInodeNumber;
 	std::memset(entryOnDisk.d_name, 0, MINIX3_DIR_NAME_MAX);
 	std::memcpy(entryOnDisk.d_name, entryName.c_str(), entryName.size());
-	return fileWriter->writeFile(dirInodeNumber, reinterpret_cast<const uint8_t*>(&entryOnDisk), entryIndex * sizeof(DirEntryOnDisk), sizeof(DirEntryOnDisk));
+	if (entryInodeNumber != 0)
+	{
+		dentryCache->invalidate(dirInodeNumber, entryName);
+	}
+	err = fileWriter->writeFile(dirInodeNumber, reinterpret_cast<const uint8_t*>(&entryOnDisk), entryIndex * sizeof(DirEntryOnDisk), sizeof(DirEntryOnDisk));
+	if (err != SUCCESS)
+	{
+		return err;
+	}
+	if (entryInodeNumber != 0)
+	{
+		dirIndex->noteWrite(dirInodeNumber, entryIndex, entryInodeNumber, entryName);
+	}
+	return SUCCESS;
 }
\ No newline at end of file
@@ -5,17 +5,76 @@
 #include "IndirectBlock.h"
 #include "DirEntry.h"
 #include <cstring>
+#include <limits>
+#include <algorithm>
 #include <fcntl.h>
 
-FS::FS(): g_BlockDevice(), g_Superblock() {}
+FS::FS(): g_BlockDevice(), g_Superblock(), readaheadZones(READAHEAD_DEFAULT_MAX_ZONES), orderedData(false) {}
 
-FS::FS(const std::string &devicePath): g_BlockDevice(devicePath), g_Superblock() {}
+FS::FS(const std::string &devicePath): g_BlockDevice(devicePath), g_Superblock(), readaheadZones(READAHEAD_DEFAULT_MAX_ZONES), orderedData(false) {}
+
+FS::FS(std::unique_ptr<BlockBackend> backend): g_BlockDevice(std::move(backend)), g_Superblock(), readaheadZones(READAHEAD_DEFAULT_MAX_ZONES), orderedData(false) {}
 
 void FS::setDevicePath(const std::string &devicePath)
 {
 	g_BlockDevice.setDevicePath(devicePath);
 }
 
+void FS::setCacheCapacity(uint32_t blocks)
+{
+	g_BlockDevice.setCacheCapacity(blocks);
+}
+
+void FS::setIoUring(bool enabled)
+{
+	g_BlockDevice.setIoUring(enabled);
+}
+
+bool FS::isIoUringEnabled() const
+{
+	return g_BlockDevice.isIoUringEnabled();
+}
+
+void FS::setDirectIO(bool enabled)
+{
+	g_BlockDevice.setDirectIO(enabled);
+}
+
+bool FS::isDirectIOEnabled() const
+{
+	return g_BlockDevice.isDirectIOEnabled();
+}
+
+void FS::setMmap(bool enabled)
+{
+	g_BlockDevice.setMmap(enabled);
+}
+
+bool FS::isMmapEnabled() const
+{
+	return g_BlockDevice.isMmapEnabled();
+}
+
+void FS::setReadaheadZones(uint32_t zones)
+{
+	readaheadZones = zones;
+}
+
+void FS::setOrderedData(bool enabled)
+{
+	orderedData = enabled;
+}
+
+void FS::setJournalPath(const std::string &journalPath)
+{
+	g_BlockDevice.setJournalPath(journalPath);
+}
+
+bool FS::isJournalEnabled() const
+{
+	return g_BlockDevice.isJournalEnabled();
+}
+
 ErrorCode FS::mount()
 {
 	BlockDevice &bd = g_BlockDevice;
@@ -42,12 +101,24 @@ ErrorCode FS::mount()
 	}
 	bd.setBlockSize(layout.blockSize);
 	bd.setZoneSize(layout.zoneSize);
+	err = bd.initCache();
+	if (err != SUCCESS)
+	{
+		bd.close();
+		return err;
+	}
+
+	g_InodeCache.clear();
+	g_InodeCache.setBlockDevice(bd);
+	g_InodeCache.setLayout(layout);
+
+	g_DentryCache.clear();
+	g_PathCache.clear();
 
-	g_InodeReader.setBlockDevice(bd);
 	g_InodeReader.setLayout(layout);
+	g_InodeReader.setInodeCache(g_InodeCache);
 
-	g_InodeWriter.setBlockDevice(bd);
-	g_InodeWriter.setLayout(layout);
+	g_InodeWriter.setInodeCache(g_InodeCache);
 
 	g_FileMapper.setBlockDevice(bd);
 	g_FileMapper.setInodeReader(g_InodeReader);
@@ -68,16 +139,24 @@ ErrorCode FS::mount()
 	g_DirReader.setInodeReader(g_InodeReader);
 	g_DirReader.setFileReader(g_FileReader);
 
+	g_DirIndex.clear();
+	g_DirIndex.setInodeReader(g_InodeReader);
+	g_DirIndex.setDirReader(g_DirReader);
+
 	g_DirWriter.setInodeReader(g_InodeReader);
 	g_DirWriter.setInodeWriter(g_InodeWriter);
 	g_DirWriter.setDirReader(g_DirReader);
 	g_DirWriter.setFileWriter(g_FileWriter);
+	g_DirWriter.setDentryCache(g_DentryCache);
+	g_DirWriter.setDirIndex(g_DirIndex);
 
 	g_FileCreator.setInodeReader(g_InodeReader);
 	g_FileCreator.setInodeWriter(g_InodeWriter);
 	g_FileCreator.setDirReader(g_DirReader);
 	g_FileCreator.setDirWriter(g_DirWriter);
+	g_FileCreator.setDirIndex(g_DirIndex);
 	g_FileCreator.setImapAllocator(g_imapAllocator);
+	g_FileCreator.setInodesPerBlock(layout.inodesPerBlock);
 
 	g_LinkReader.setInodeReader(g_InodeReader);
 	g_LinkReader.setFileReader(g_FileReader);
@@ -85,10 +164,12 @@ ErrorCode FS::mount()
 	g_PathResolver.setInodeReader(g_InodeReader);
 	g_PathResolver.setDirReader(g_DirReader);
 	g_PathResolver.setLinkReader(g_LinkReader);
+	g_PathResolver.setDentryCache(g_DentryCache);
+	g_PathResolver.setPathCache(g_PathCache);
+	g_PathResolver.setDirIndex(g_DirIndex);
 
 	g_FileDeleter.setImapAllocator(g_imapAllocator);
 	g_FileDeleter.setFileWriter(g_FileWriter);
-	g_FileDeleter.setFileCounter(g_FileCounter);
 	g_FileDeleter.setDirReader(g_DirReader);
 	g_FileDeleter.setDirWriter(g_DirWriter);
 	g_FileDeleter.setInodeReader(g_InodeReader);
@@ -104,6 +185,8 @@ ErrorCode FS::mount()
 	g_DirDeleter.setDirReader(g_DirReader);
 	g_DirDeleter.setFileDeleter(g_FileDeleter);
 	g_DirDeleter.setPathResolver(g_PathResolver);
+	g_DirDeleter.setDentryCache(g_DentryCache);
+	g_DirDeleter.setDirIndex(g_DirIndex);
 
 	g_FileRenamer.setDirReader(g_DirReader);
 	g_FileRenamer.setDirWriter(g_DirWriter);
@@ -127,6 +210,7 @@ ErrorCode FS::mount()
 	g_AttributeUpdater.setInodeWriter(g_InodeWriter);
 
 	g_imapAllocator.setBlockDevice(bd);
+	g_imapAllocator.setGroupBits(ALLOCATE_INODE_GROUP_INODES);
 	err = g_imapAllocator.init(layout.imapStart, layout.totalInodes + 1, 1, layout.blockSize);
 	if (err != SUCCESS)
 	{
@@ -142,17 +226,40 @@ ErrorCode FS::mount()
 		return err;
 	}
 	g_FileMapper.setZmapAllocator(g_zmapAllocator);
+	g_FileWriter.setZmapAllocator(g_zmapAllocator);
+	g_FileWriter.setOrderedData(orderedData);
 
 	g_TransactionManager.setBlockDevice(bd);
 	g_TransactionManager.setImapAllocator(g_imapAllocator);
 	g_TransactionManager.setZmapAllocator(g_zmapAllocator);
+	g_TransactionManager.setInodeCache(g_InodeCache);
+	g_TransactionManager.setDentryCache(g_DentryCache);
+	g_TransactionManager.setPathCache(g_PathCache);
+	g_TransactionManager.setDirIndex(g_DirIndex);
+
+	g_Readahead.setLayout(layout);
+	g_Readahead.setInodeReader(g_InodeReader);
+	g_Readahead.setFileReader(g_FileReader);
+	g_Readahead.setTransactionManager(g_TransactionManager);
+	g_Readahead.setMaxWindowZones(std::min(readaheadZones, bd.getCacheCapacity() / layout.blocksPerZone / 4));
 
 	return SUCCESS;
 }
 
 ErrorCode FS::unmount()
 {
+	g_Readahead.stop();
+	auto lock = g_TransactionManager.lockForWrite();
 	ErrorCode err = SUCCESS;
+	for (Ino inodeNumber : g_FileCounter.inodes())
+	{
+		g_FileCounter.remove(inodeNumber, std::numeric_limits<uint64_t>::max());
+		err = deleteIfOrphanLocked(inodeNumber);
+		if (err != SUCCESS)
+		{
+			return err;
+		}
+	}
 	ErrorCode imapErr = g_imapAllocator.sync();
 	ErrorCode zmapErr = g_zmapAllocator.sync();
 	if (imapErr != SUCCESS)
@@ -172,6 +279,22 @@ uint16_t FS::getBlockSize() const
 }
 
 uint32_t FS::readFile(Ino inodeNumber, uint8_t *buffer, uint32_t offset, uint32_t sizeToRead, ErrorCode &outError)
+{
+	auto lock = g_TransactionManager.lockForRead();
+	return readFileLocked(inodeNumber, buffer, offset, sizeToRead, outError);
+}
+
+uint32_t FS::readFile(FileHandle &handle, uint8_t *buffer, uint32_t offset, uint32_t sizeToRead, ErrorCode &outError)
+{
+	uint32_t bytesRead = readFile(handle.inodeNumber, buffer, offset, sizeToRead, outError);
+	if (outError == SUCCESS)
+	{
+		g_Readahead.onRead(handle.readahead, handle.inodeNumber, offset, bytesRead);
+	}
+	return bytesRead;
+}
+
+uint32_t FS::readFileLocked(Ino inodeNumber, uint8_t *buffer, uint32_t offset, uint32_t sizeToRead, ErrorCode &outError)
 {
 	MinixInode3 fileInode;
 	ErrorCode err = g_InodeReader.readInode(inodeNumber, &fileInode);
@@ -203,6 +326,12 @@ uint32_t FS::readFile(Ino inodeNumber, uint8_t *buffer, uint32_t offset, uint32_
 }
 
 uint32_t FS::writeFile(Ino inodeNumber, const uint8_t *data, uint32_t offset, uint32_t sizeToWrite, ErrorCode &outError)
+{
+	auto lock = g_TransactionManager.lockForWrite();
+	return writeFileLocked(inodeNumber, data, offset, sizeToWrite, outError);
+}
+
+uint32_t FS::writeFileLocked(Ino inodeNumber, const uint8_t *data, uint32_t offset, uint32_t sizeToWrite, ErrorCode &outError)
 {
 	ErrorCode err = g_TransactionManager.beginTransaction();
 	if (err != SUCCESS)
@@ -227,35 +356,53 @@ uint32_t FS::writeFile(Ino inodeNumber, const uint8_t *data, uint32_t offset, ui
 
 uint32_t FS::readFile(const std::string &path, uint8_t *buffer, uint32_t offset, uint32_t sizeToRead, ErrorCode &outError)
 {
+	auto lock = g_TransactionManager.lockForRead();
 	Ino inodeNumber = g_PathResolver.resolvePath(path, outError);
 	if (outError != SUCCESS)
 	{
 		return 0;
 	}
-	return readFile(inodeNumber, buffer, offset, sizeToRead, outError);
+	return readFileLocked(inodeNumber, buffer, offset, sizeToRead, outError);
 }
 
 uint32_t FS::writeFile(const std::string &path, const uint8_t *data, uint32_t offset, uint32_t sizeToWrite, ErrorCode &outError)
 {
+	auto lock = g_TransactionManager.lockForWrite();
 	Ino inodeNumber = g_PathResolver.resolvePath(path, outError);
 	if (outError != SUCCESS)
 	{
 		return 0;
 	}
-	return writeFile(inodeNumber, data, offset, sizeToWrite, outError);
+	return writeFileLocked(inodeNumber, data, offset, sizeToWrite, outError);
 }
 
 Ino FS::createFile(const std::string &path, const std::string &name, uint16_t mode, uint16_t uid, uint16_t gid, ErrorCode &outError)
 {
-	outError = g_TransactionManager.beginTransaction();
+	auto lock = g_TransactionManager.lockForWrite();
+	Ino parentInodeNumber = g_PathResolver.resolvePath(path, outError);
 	if (outError != SUCCESS)
 	{
 		return 0;
 	}
-	Ino parentInodeNumber = g_PathResolver.resolvePath(path, outError);
+	return createFileLocked(parentInodeNumber, name, mode, uid, gid, outError);
+}
+
+Ino FS::createFile(Ino parentInodeNumber, const std::string &name, uint16_t mode, uint16_t uid, uint16_t gid, ErrorCode &outError)
+{
+	auto lock = g_TransactionManager.lockForWrite();
+	Ino newInodeNumber = createFileLocked(parentInodeNumber, name, mode, uid, gid, outError);
+	if (outError == SUCCESS)
+	{
+		g_FileCounter.add(newInodeNumber);
+	}
+	return newInodeNumber;
+}
+
+Ino FS::createFileLocked(Ino parentInodeNumber, const std::string &name, uint16_t mode, uint16_t uid, uint16_t gid, ErrorCode &outError)
+{
+	outError = g_TransactionManager.beginTransaction();
 	if (outError != SUCCESS)
 	{
-		g_TransactionManager.revertTransaction();
 		return 0;
 	}
 	Ino newInodeNumber = g_FileCreator.createFile(parentInodeNumber, name, mode, uid, gid, outError);
@@ -274,16 +421,32 @@ Ino FS::createFile(const std::string &path, const std::string &name, uint16_t mo
 
 Ino FS::createSymlink(const std::string &target, const std::string &path, uint16_t mode, uint16_t uid, uint16_t gid, ErrorCode &outError)
 {
-	outError = g_TransactionManager.beginTransaction();
+	auto lock = g_TransactionManager.lockForWrite();
+	auto [parentPath, name] = splitPathIntoDirAndBase(path);
+	Ino parentInodeNumber = g_PathResolver.resolvePath(parentPath, outError);
 	if (outError != SUCCESS)
 	{
 		return 0;
 	}
-	auto [parentPath, name] = splitPathIntoDirAndBase(path);
-	Ino parentInodeNumber = g_PathResolver.resolvePath(parentPath, outError);
+	return createSymlinkLocked(target, parentInodeNumber, name, mode, uid, gid, outError);
+}
+
+Ino FS::createSymlink(const std::string &target, Ino parentInodeNumber, const std::string &name, uint16_t mode, uint16_t uid, uint16_t gid, ErrorCode &outError)
+{
+	auto lock = g_TransactionManager.lockForWrite();
+	Ino symlinkInodeNumber = createSymlinkLocked(target, parentInodeNumber, name, mode, uid, gid, outError);
+	if (outError == SUCCESS)
+	{
+		g_FileCounter.add(symlinkInodeNumber);
+	}
+	return symlinkInodeNumber;
+}
+
+Ino FS::createSymlinkLocked(const std::string &target, Ino parentInodeNumber, const std::string &name, uint16_t mode, uint16_t uid, uint16_t gid, ErrorCode &outError)
+{
+	outError = g_TransactionManager.beginTransaction();
 	if (outError != SUCCESS)
 	{
-		g_TransactionManager.revertTransaction();
 		return 0;
 	}
 	Ino symlinkInodeNumber = g_SymlinkCreator.createSymlink(parentInodeNumber, name, target, mode, uid, gid, outError);
@@ -302,16 +465,23 @@ Ino FS::createSymlink(const std::string &target, const std::string &path, uint16
 
 ErrorCode FS::truncateFile(const std::string &path, uint32_t newSize)
 {
+	auto lock = g_TransactionManager.lockForWrite();
 	ErrorCode err;
 	Ino inodeNumber = g_PathResolver.resolvePath(path, err);
 	if (err != SUCCESS)
 	{
 		return err;
 	}
-	return truncateFile(inodeNumber, newSize);
+	return truncateFileLocked(inodeNumber, newSize);
 }
 
 ErrorCode FS::truncateFile(Ino inodeNumber, uint32_t newSize)
+{
+	auto lock = g_TransactionManager.lockForWrite();
+	return truncateFileLocked(inodeNumber, newSize);
+}
+
+ErrorCode FS::truncateFileLocked(Ino inodeNumber, uint32_t newSize)
 {
 	ErrorCode err = g_TransactionManager.beginTransaction();
 	if (err != SUCCESS)
@@ -346,11 +516,13 @@ ErrorCode FS::truncateFile(Ino inodeNumber, uint32_t newSize)
 
 ErrorCode FS::renameFile(const std::string &from, const std::string &to, bool failIfDstExists)
 {
+	auto lock = g_TransactionManager.lockForWrite();
 	ErrorCode err = g_TransactionManager.beginTransaction();
 	if (err != SUCCESS)
 	{
 		return err;
 	}
+	g_FileDeleter.orphans.clear();
 	auto [srcParentPath, srcName] = splitPathIntoDirAndBase(from);
 	auto [dstParentPath, dstName] = splitPathIntoDirAndBase(to);
 	Ino srcParentInodeNumber = g_PathResolver.resolvePath(srcParentPath, err);
@@ -359,31 +531,47 @@ ErrorCode FS::renameFile(const std::string &from, const std::string &to, bool fa
 		g_TransactionManager.revertTransaction();
 		return err;
 	}
+	bool followedLink = g_PathResolver.resolvePathFollowedLink;
 	Ino dstParentInodeNumber = g_PathResolver.resolvePath(dstParentPath, err);
 	if (err != SUCCESS)
 	{
 		g_TransactionManager.revertTransaction();
 		return err;
 	}
+	followedLink = followedLink || g_PathResolver.resolvePathFollowedLink;
 	err = g_FileRenamer.rename(srcParentInodeNumber, srcName, dstParentInodeNumber, dstName, failIfDstExists);
 	if (err != SUCCESS)
 	{
 		g_TransactionManager.revertTransaction();
 		return err;
 	}
-	return g_TransactionManager.commitTransaction();
+	g_PathCache.invalidate(from, followedLink);
+	g_PathCache.invalidate(to, followedLink);
+	return commitAndReapOrphansLocked();
 }
 
 ErrorCode FS::openFile(const std::string &path, Ino &outInodeNumber, uint32_t flags)
 {
+	auto lock = g_TransactionManager.lockForWrite();
 	ErrorCode err;
 	outInodeNumber = g_PathResolver.resolvePath(path, err);
 	if (err != SUCCESS)
 	{
 		return err;
 	}
+	return openFileLocked(outInodeNumber, flags);
+}
+
+ErrorCode FS::openFile(Ino inodeNumber, uint32_t flags)
+{
+	auto lock = g_TransactionManager.lockForWrite();
+	return openFileLocked(inodeNumber, flags);
+}
+
+ErrorCode FS::openFileLocked(Ino inodeNumber, uint32_t flags)
+{
 	MinixInode3 inode;
-	err = g_InodeReader.readInode(outInodeNumber, &inode);
+	ErrorCode err = g_InodeReader.readInode(inodeNumber, &inode);
 	if (err != SUCCESS)
 	{
 		return err;
@@ -403,7 +591,7 @@ ErrorCode FS::openFile(const std::string &path, Ino &outInodeNumber, uint32_t fl
 		{
 			return err;
 		}
-		err = g_FileWriter.truncateFile(outInodeNumber, 0);
+		err = g_FileWriter.truncateFile(inodeNumber, 0);
 		if (err != SUCCESS)
 		{
 			g_TransactionManager.revertTransaction();
@@ -415,13 +603,32 @@ ErrorCode FS::openFile(const std::string &path, Ino &outInodeNumber, uint32_t fl
 			return err;
 		}
 	}
-	g_FileCounter.add(outInodeNumber);
+	err = g_InodeCache.acquire(inodeNumber);
+	if (err != SUCCESS)
+	{
+		return err;
+	}
+	g_FileCounter.add(inodeNumber);
 	return SUCCESS;
 }
 
 ErrorCode FS::closeFile(Ino inodeNumber)
 {
+	auto lock = g_TransactionManager.lockForWrite();
 	g_FileCounter.remove(inodeNumber);
+	g_InodeCache.release(inodeNumber);
+	return deleteIfOrphanLocked(inodeNumber);
+}
+
+ErrorCode FS::forgetInode(Ino inodeNumber, uint64_t lookupCount)
+{
+	auto lock = g_TransactionManager.lockForWrite();
+	g_FileCounter.remove(inodeNumber, lookupCount);
+	return deleteIfOrphanLocked(inodeNumber);
+}
+
+ErrorCode FS::deleteIfOrphanLocked(Ino inodeNumber)
+{
 	MinixInode3 inode;
 	ErrorCode err = g_InodeReader.readInode(inodeNumber, &inode);
 	if (err != SUCCESS)
@@ -446,24 +653,60 @@ ErrorCode FS::closeFile(Ino inodeNumber)
 	return SUCCESS;
 }
 
-ErrorCode FS::linkFile(const std::string &existingPath, const std::string &newPath)
+ErrorCode FS::commitAndReapOrphansLocked()
 {
-	ErrorCode err = g_TransactionManager.beginTransaction();
+	std::vector<Ino> orphans;
+	orphans.swap(g_FileDeleter.orphans);
+	ErrorCode err = g_TransactionManager.commitTransaction();
 	if (err != SUCCESS)
 	{
 		return err;
 	}
+	for (Ino inodeNumber : orphans)
+	{
+		err = deleteIfOrphanLocked(inodeNumber);
+		if (err != SUCCESS)
+		{
+			return err;
+		}
+	}
+	return SUCCESS;
+}
+
+ErrorCode FS::linkFile(const std::string &existingPath, const std::string &newPath)
+{
+	auto lock = g_TransactionManager.lockForWrite();
+	ErrorCode err;
 	Ino srcInodeNumber = g_PathResolver.resolvePath(existingPath, err, MINIX3_ROOT_INODE, false);
 	if (err != SUCCESS)
 	{
-		g_TransactionManager.revertTransaction();
 		return err;
 	}
 	auto [dstParentPath, dstName] = splitPathIntoDirAndBase(newPath);
 	Ino dstParentInodeNumber = g_PathResolver.resolvePath(dstParentPath, err);
 	if (err != SUCCESS)
 	{
-		g_TransactionManager.revertTransaction();
+		return err;
+	}
+	return linkFileLocked(srcInodeNumber, dstParentInodeNumber, dstName);
+}
+
+ErrorCode FS::linkFile(Ino inodeNumber, Ino newParentInodeNumber, const std::string &newName)
+{
+	auto lock = g_TransactionManager.lockForWrite();
+	ErrorCode err = linkFileLocked(inodeNumber, newParentInodeNumber, newName);
+	if (err == SUCCESS)
+	{
+		g_FileCounter.add(inodeNumber);
+	}
+	return err;
+}
+
+ErrorCode FS::linkFileLocked(Ino srcInodeNumber, Ino dstParentInodeNumber, const std::string &dstName)
+{
+	ErrorCode err = g_TransactionManager.beginTransaction();
+	if (err != SUCCESS)
+	{
 		return err;
 	}
 	MinixInode3 srcInode;
@@ -489,11 +732,13 @@ ErrorCode FS::linkFile(const std::string &existingPath, const std::string &newPa
 
 ErrorCode FS::unlinkFile(const std::string &path)
 {
+	auto lock = g_TransactionManager.lockForWrite();
 	ErrorCode err = g_TransactionManager.beginTransaction();
 	if (err != SUCCESS)
 	{
 		return err;
 	}
+	g_FileDeleter.orphans.clear();
 	auto [parentPath, name] = splitPathIntoDirAndBase(path);
 	Ino parentInodeNumber = g_PathResolver.resolvePath(parentPath, err);
 	if (err != SUCCESS)
@@ -513,6 +758,7 @@ ErrorCode FS::unlinkFile(const std::string &path)
 		g_TransactionManager.revertTransaction();
 		return err;
 	}
+	bool followedLink = g_PathResolver.resolvePathFollowedLink;
 	MinixInode3 inode;
 	err = g_InodeReader.readInode(inodeNumber, &inode);
 	if (err != SUCCESS)
@@ -531,34 +777,103 @@ ErrorCode FS::unlinkFile(const std::string &path)
 		g_TransactionManager.revertTransaction();
 		return err;
 	}
-	return g_TransactionManager.commitTransaction();
+	g_PathCache.invalidate(path, followedLink);
+	return commitAndReapOrphansLocked();
 }
 
-ErrorCode FS::mkdir(const std::string &path, uint16_t mode, uint16_t uid, uint16_t gid)
+ErrorCode FS::unlinkFile(Ino parentInodeNumber, const std::string &name)
 {
+	auto lock = g_TransactionManager.lockForWrite();
 	ErrorCode err = g_TransactionManager.beginTransaction();
 	if (err != SUCCESS)
 	{
 		return err;
 	}
-	auto [parentPath, name] = splitPathIntoDirAndBase(path);
-	Ino parentInodeNumber = g_PathResolver.resolvePath(parentPath, err);
+	g_FileDeleter.orphans.clear();
+	uint32_t idx;
+	Ino inodeNumber = g_PathResolver.lookupEntry(parentInodeNumber, name, idx, err);
 	if (err != SUCCESS)
 	{
 		g_TransactionManager.revertTransaction();
 		return err;
 	}
-	err = g_DirCreator.createDir(parentInodeNumber, name, mode, uid, gid);
+	MinixInode3 inode;
+	err = g_InodeReader.readInode(inodeNumber, &inode);
 	if (err != SUCCESS)
 	{
 		g_TransactionManager.revertTransaction();
 		return err;
 	}
-	return g_TransactionManager.commitTransaction();
+	if (inode.isDirectory())
+	{
+		g_TransactionManager.revertTransaction();
+		return ERROR_UNLINK_DIRECTORY;
+	}
+	err = g_FileDeleter.unlinkFile(parentInodeNumber, idx);
+	if (err != SUCCESS)
+	{
+		g_TransactionManager.revertTransaction();
+		return err;
+	}
+	g_PathCache.clear();
+	return commitAndReapOrphansLocked();
+}
+
+ErrorCode FS::mkdir(const std::string &path, uint16_t mode, uint16_t uid, uint16_t gid)
+{
+	auto lock = g_TransactionManager.lockForWrite();
+	ErrorCode err;
+	auto [parentPath, name] = splitPathIntoDirAndBase(path);
+	Ino parentInodeNumber = g_PathResolver.resolvePath(parentPath, err);
+	if (err != SUCCESS)
+	{
+		return err;
+	}
+	mkdirLocked(parentInodeNumber, name, mode, uid, gid, err);
+	return err;
+}
+
+Ino FS::mkdir(Ino parentInodeNumber, const std::string &name, uint16_t mode, uint16_t uid, uint16_t gid, ErrorCode &outError)
+{
+	auto lock = g_TransactionManager.lockForWrite();
+	Ino dirInodeNumber = mkdirLocked(parentInodeNumber, name, mode, uid, gid, outError);
+	if (outError == SUCCESS)
+	{
+		g_FileCounter.add(dirInodeNumber);
+	}
+	return dirInodeNumber;
+}
+
+Ino FS::mkdirLocked(Ino parentInodeNumber, const std::string &name, uint16_t mode, uint16_t uid, uint16_t gid, ErrorCode &outError)
+{
+	outError = g_TransactionManager.beginTransaction();
+	if (outError != SUCCESS)
+	{
+		return 0;
+	}
+	outError = g_DirCreator.createDir(parentInodeNumber, name, mode, uid, gid);
+	if (outError != SUCCESS)
+	{
+		g_TransactionManager.revertTransaction();
+		return 0;
+	}
+	Ino dirInodeNumber = g_PathResolver.getInodeFromParentAndName(parentInodeNumber, name, outError);
+	if (outError != SUCCESS)
+	{
+		g_TransactionManager.revertTransaction();
+		return 0;
+	}
+	outError = g_TransactionManager.commitTransaction();
+	if (outError != SUCCESS)
+	{
+		return 0;
+	}
+	return dirInodeNumber;
 }
 
 ErrorCode FS::rmdir(const std::string &path)
 {
+	auto lock = g_TransactionManager.lockForWrite();
 	if (path == "/")
 	{
 		return ERROR_DELETE_ROOT_DIR;
@@ -569,23 +884,81 @@ ErrorCode FS::rmdir(const std::string &path)
 	{
 		return err;
 	}
+	g_FileDeleter.orphans.clear();
 	Ino parentInodeNumber = g_PathResolver.resolvePath(parentPath, err);
 	if (err != SUCCESS)
 	{
 		g_TransactionManager.revertTransaction();
 		return err;
 	}
+	bool followedLink = g_PathResolver.resolvePathFollowedLink;
 	err =  g_DirDeleter.deleteDir(parentInodeNumber, name);
 	if (err != SUCCESS)
 	{
 		g_TransactionManager.revertTransaction();
 		return err;
 	}
-	return g_TransactionManager.commitTransaction();
+	g_PathCache.invalidate(path, followedLink);
+	return commitAndReapOrphansLocked();
+}
+
+ErrorCode FS::rmdir(Ino parentInodeNumber, const std::string &name)
+{
+	auto lock = g_TransactionManager.lockForWrite();
+	ErrorCode err = g_TransactionManager.beginTransaction();
+	if (err != SUCCESS)
+	{
+		return err;
+	}
+	g_FileDeleter.orphans.clear();
+	err = g_DirDeleter.deleteDir(parentInodeNumber, name);
+	if (err != SUCCESS)
+	{
+		g_TransactionManager.revertTransaction();
+		return err;
+	}
+	g_PathCache.clear();
+	return commitAndReapOrphansLocked();
+}
+
+ErrorCode FS::renameFile(Ino srcParentInodeNumber, const std::string &srcName, Ino dstParentInodeNumber, const std::string &dstName, bool failIfDstExists)
+{
+	auto lock = g_TransactionManager.lockForWrite();
+	ErrorCode err = g_TransactionManager.beginTransaction();
+	if (err != SUCCESS)
+	{
+		return err;
+	}
+	g_FileDeleter.orphans.clear();
+	err = g_FileRenamer.rename(srcParentInodeNumber, srcName, dstParentInodeNumber, dstName, failIfDstExists);
+	if (err != SUCCESS)
+	{
+		g_TransactionManager.revertTransaction();
+		return err;
+	}
+	g_PathCache.clear();
+	return commitAndReapOrphansLocked();
+}
+
+Ino FS::lookup(Ino parentInodeNumber, const std::string &name, ErrorCode &outError)
+{
+	auto lock = g_TransactionManager.lockForRead();
+	if (name.size() > MINIX3_DIR_NAME_MAX)
+	{
+		outError = ERROR_NAME_LENGTH_EXCEEDED;
+		return 0;
+	}
+	Ino inodeNumber = g_PathResolver.getInodeFromParentAndName(parentInodeNumber, name, outError);
+	if (outError == SUCCESS)
+	{
+		g_FileCounter.add(inodeNumber);
+	}
+	return inodeNumber;
 }
 
 struct stat FS::getFileStat(const std::string &path, ErrorCode &outError)
 {
+	auto lock = g_TransactionManager.lockForRead();
 	Ino inodeNumber = g_PathResolver.resolvePath(path, outError, MINIX3_ROOT_INODE, false);
 	if (outError != SUCCESS)
 	{
@@ -594,7 +967,19 @@ struct stat FS::getFileStat(const std::string &path, ErrorCode &outError)
 	return g_InodeReader.readStat(inodeNumber, outError);
 }
 
+struct stat FS::getFileStat(Ino inodeNumber, ErrorCode &outError)
+{
+	auto lock = g_TransactionManager.lockForRead();
+	return g_InodeReader.readStat(inodeNumber, outError);
+}
+
 uint32_t FS::getDirectorySize(Ino inodeNumber, ErrorCode &outError)
+{
+	auto lock = g_TransactionManager.lockForRead();
+	return getDirectorySizeLocked(inodeNumber, outError);
+}
+
+uint32_t FS::getDirectorySizeLocked(Ino inodeNumber, ErrorCode &outError)
 {
 	MinixInode3 dirInode;
 	ErrorCode err = g_InodeReader.readInode(inodeNumber, &dirInode);
@@ -614,30 +999,51 @@ uint32_t FS::getDirectorySize(Ino inodeNumber, ErrorCode &outError)
 
 uint32_t FS::getDirectorySize(const std::string &path, ErrorCode &outError)
 {
+	auto lock = g_TransactionManager.lockForRead();
 	Ino dirInodeNumber = g_PathResolver.resolvePath(path, outError);
 	if (outError != SUCCESS)
 	{
 		return 0;
 	}
-	return getDirectorySize(dirInodeNumber, outError);
+	return getDirectorySizeLocked(dirInodeNumber, outError);
 }
 
-std::vector<DirEntry> FS::listDir(Ino inodeNumber, uint32_t offset, uint32_t count, ErrorCode &outError)
+std::vector<DirEntry> FS::listDir(Ino inodeNumber, uint32_t offset, uint32_t count, ErrorCode &outError, bool retain)
 {
-	return g_DirReader.readDir(inodeNumber, offset, count, outError);
+	auto lock = g_TransactionManager.lockForRead();
+	std::vector<DirEntry> entries = g_DirReader.readDir(inodeNumber, offset, count, outError, false, true);
+	if (outError == SUCCESS && retain)
+	{
+		for (const DirEntry &entry : entries)
+		{
+			std::string name = char60ToString(entry.raw.d_name);
+			if (name != "." && name != "..")
+			{
+				g_FileCounter.add(entry.raw.d_inode);
+			}
+		}
+	}
+	return entries;
 }
 
 std::vector<DirEntry> FS::listDir(const std::string &path, uint32_t offset, uint32_t count, ErrorCode &outError)
 {
+	auto lock = g_TransactionManager.lockForRead();
 	Ino dirInodeNumber = g_PathResolver.resolvePath(path, outError);
 	if (outError != SUCCESS)
 	{
 		return {};
 	}
-	return listDir(dirInodeNumber, offset, count, outError);
+	return g_DirReader.readDir(dirInodeNumber, offset, count, outError, false, true);
 }
 
 std::vector<DirEntry> FS::listDir(Ino inodeNumber, ErrorCode &outError)
+{
+	auto lock = g_TransactionManager.lockForRead();
+	return listDirLocked(inodeNumber, outError);
+}
+
+std::vector<DirEntry> FS::listDirLocked(Ino inodeNumber, ErrorCode &outError)
 {
 	MinixInode3 dirInode;
 	ErrorCode err = g_InodeReader.readInode(inodeNumber, &dirInode);
@@ -652,26 +1058,39 @@ std::vector<DirEntry> FS::listDir(Ino inodeNumber, ErrorCode &outError)
 		return {};
 	}
 	uint32_t totalEntries = dirInode.i_size / sizeof(DirEntryOnDisk);
-	return g_DirReader.readDir(inodeNumber, 0, totalEntries, outError);
+	return g_DirReader.readDir(inodeNumber, 0, totalEntries, outError, false, true);
 }
 
 std::vector<DirEntry> FS::listDir(const std::string &path, ErrorCode &outError)
 {
+	auto lock = g_TransactionManager.lockForRead();
 	Ino dirInodeNumber = g_PathResolver.resolvePath(path, outError);
 	if (outError != SUCCESS)
 	{
 		return {};
 	}
-	return listDir(dirInodeNumber, outError);
+	return listDirLocked(dirInodeNumber, outError);
 }
 
 std::string FS::readLink(const std::string &path, ErrorCode &outError)
 {
+	auto lock = g_TransactionManager.lockForRead();
 	Ino inodeNumber = g_PathResolver.resolvePath(path, outError, MINIX3_ROOT_INODE, false);
 	if (outError != SUCCESS)
 	{
 		return {};
 	}
+	return readLinkLocked(inodeNumber, outError);
+}
+
+std::string FS::readLink(Ino inodeNumber, ErrorCode &outError)
+{
+	auto lock = g_TransactionManager.lockForRead();
+	return readLinkLocked(inodeNumber, outError);
+}
+
+std::string FS::readLinkLocked(Ino inodeNumber, ErrorCode &outError)
+{
 	std::string linkTarget;
 	ErrorCode err = g_LinkReader.readLink(inodeNumber, linkTarget);
 	if (err != SUCCESS)
@@ -685,6 +1104,7 @@ std::string FS::readLink(const std::string &path, ErrorCode &outError)
 
 struct statvfs FS::getFSStat(ErrorCode &outError)
 {
+	auto lock = g_TransactionManager.lockForRead();
 	struct statvfs st{};
 	st.f_bsize = g_Layout.blockSize;
 	st.f_frsize = g_Layout.blockSize;
@@ -703,15 +1123,27 @@ struct statvfs FS::getFSStat(ErrorCode &outError)
 
 ErrorCode FS::chmod(const std::string &path, uint16_t mode)
 {
-	ErrorCode err = g_TransactionManager.beginTransaction();
+	auto lock = g_TransactionManager.lockForWrite();
+	ErrorCode err;
+	Ino inodeNumber = g_PathResolver.resolvePath(path, err, MINIX3_ROOT_INODE, false);
 	if (err != SUCCESS)
 	{
 		return err;
 	}
-	Ino inodeNumber = g_PathResolver.resolvePath(path, err, MINIX3_ROOT_INODE, false);
+	return chmodLocked(inodeNumber, mode);
+}
+
+ErrorCode FS::chmod(Ino inodeNumber, uint16_t mode)
+{
+	auto lock = g_TransactionManager.lockForWrite();
+	return chmodLocked(inodeNumber, mode);
+}
+
+ErrorCode FS::chmodLocked(Ino inodeNumber, uint16_t mode)
+{
+	ErrorCode err = g_TransactionManager.beginTransaction();
 	if (err != SUCCESS)
 	{
-		g_TransactionManager.revertTransaction();
 		return err;
 	}
 	err = g_AttributeUpdater.chmod(inodeNumber, mode);
@@ -725,15 +1157,27 @@ ErrorCode FS::chmod(const std::string &path, uint16_t mode)
 
 ErrorCode FS::chown(const std::string &path, uint16_t uid, uint16_t gid, bool updateUID, bool updateGID)
 {
-	ErrorCode err = g_TransactionManager.beginTransaction();
+	auto lock = g_TransactionManager.lockForWrite();
+	ErrorCode err;
+	Ino inodeNumber = g_PathResolver.resolvePath(path, err, MINIX3_ROOT_INODE, false);
 	if (err != SUCCESS)
 	{
 		return err;
 	}
-	Ino inodeNumber = g_PathResolver.resolvePath(path, err, MINIX3_ROOT_INODE, false);
+	return chownLocked(inodeNumber, uid, gid, updateUID, updateGID);
+}
+
+ErrorCode FS::chown(Ino inodeNumber, uint16_t uid, uint16_t gid, bool updateUID, bool updateGID)
+{
+	auto lock = g_TransactionManager.lockForWrite();
+	return chownLocked(inodeNumber, uid, gid, updateUID, updateGID);
+}
+
+ErrorCode FS::chownLocked(Ino inodeNumber, uint16_t uid, uint16_t gid, bool updateUID, bool updateGID)
+{
+	ErrorCode err = g_TransactionManager.beginTransaction();
 	if (err != SUCCESS)
 	{
-		g_TransactionManager.revertTransaction();
 		return err;
 	}
 	err = g_AttributeUpdater.chown(inodeNumber, uid, gid, updateUID, updateGID);
@@ -747,15 +1191,27 @@ ErrorCode FS::chown(const std::string &path, uint16_t uid, uint16_t gid, bool up
 
 ErrorCode FS::utimens(const std::string &path, uint32_t atime, uint32_t mtime, bool updateAtime, bool updateMtime)
 {
-	ErrorCode err = g_TransactionManager.beginTransaction();
+	auto lock = g_TransactionManager.lockForWrite();
+	ErrorCode err;
+	Ino inodeNumber = g_PathResolver.resolvePath(path, err, MINIX3_ROOT_INODE, false);
 	if (err != SUCCESS)
 	{
 		return err;
 	}
-	Ino inodeNumber = g_PathResolver.resolvePath(path, err, MINIX3_ROOT_INODE, false);
+	return utimensLocked(inodeNumber, atime, mtime, updateAtime, updateMtime);
+}
+
+ErrorCode FS::utimens(Ino inodeNumber, uint32_t atime, uint32_t mtime, bool updateAtime, bool updateMtime)
+{
+	auto lock = g_TransactionManager.lockForWrite();
+	return utimensLocked(inodeNumber, atime, mtime, updateAtime, updateMtime);
+}
+
+ErrorCode FS::utimensLocked(Ino inodeNumber, uint32_t atime, uint32_t mtime, bool updateAtime, bool updateMtime)
+{
+	ErrorCode err = g_TransactionManager.beginTransaction();
 	if (err != SUCCESS)
 	{
-		g_TransactionManager.revertTransaction();
 		return err;
 	}
 	err = g_AttributeUpdater.utimens(inodeNumber, atime, mtime, updateAtime, updateMtime);
@@ -769,6 +1225,7 @@ ErrorCode FS::utimens(const std::string &path, uint32_t atime, uint32_t mtime, b
 
 ErrorCode FS::fsync(bool syncDataOnly)
 {
+	auto lock = g_TransactionManager.lockForWrite();
 	if (g_TransactionManager.isInTransaction)
 	{
 		return ERROR_IS_IN_TRANSACTION;
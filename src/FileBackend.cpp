@@ -0,0 +1,527 @@
+#include "FileBackend.h"
+#include <unistd.h>
+#include <cstring>
+#include <algorithm>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <functional>
+#include <thread>
+#include <cstdlib>
+#include "Constants.h"
+
+FileBackend::FileBackend(): devicePath(""), fd(-1), ioUringRequested(false), directIORequested(false), directIOAlignment(0), mmapRequested(false), mapping(nullptr), mappingSize(0) {}
+
+FileBackend::FileBackend(const std::string &path): devicePath(path), fd(-1), ioUringRequested(false), directIORequested(false), directIOAlignment(0), mmapRequested(false), mapping(nullptr), mappingSize(0) {}
+
+FileBackend::~FileBackend()
+{
+	rings.reset();
+	if (mapping != nullptr)
+	{
+		munmap(mapping, mappingSize);
+	}
+	if (fd >= 0)
+	{
+		::close(fd);
+	}
+}
+
+void FileBackend::setDevicePath(const std::string &path)
+{
+	devicePath = path;
+}
+
+struct DirectIOBuffer
+{
+	uint8_t *data = nullptr;
+	~DirectIOBuffer()
+	{
+		free(data);
+	}
+};
+
+static uint8_t *directIOBuffer()
+{
+	static thread_local DirectIOBuffer buffer;
+	if (buffer.data == nullptr)
+	{
+		void *memory = nullptr;
+		if (posix_memalign(&memory, DIRECT_IO_MAX_ALIGNMENT, DIRECT_IO_BOUNCE_BYTES) != 0)
+		{
+			return nullptr;
+		}
+		buffer.data = static_cast<uint8_t*>(memory);
+	}
+	return buffer.data;
+}
+
+ErrorCode FileBackend::open()
+{
+	directIOAlignment = 0;
+	fd = -1;
+	if (directIORequested && !mmapRequested)
+	{
+		fd = ::open(devicePath.c_str(), O_RDWR | O_DIRECT);
+		if (fd >= 0)
+		{
+			directIOAlignment = probeDirectIOAlignment();
+			if (directIOAlignment == 0)
+			{
+				::close(fd);
+				fd = -1;
+			}
+		}
+	}
+	if (fd < 0)
+	{
+		fd = ::open(devicePath.c_str(), O_RDWR);
+	}
+	if (fd < 0)
+	{
+		return ERROR_OPEN_DEVICE_FAIL;
+	}
+	if (mmapRequested)
+	{
+		mapDevice();
+	}
+	if (ioUringRequested && mapping == nullptr)
+	{
+		rings.reset(new IoUring[IO_URING_RINGS]);
+		for (uint32_t i = 0; i < IO_URING_RINGS; i++)
+		{
+			if (rings[i].init(fd, IO_URING_QUEUE_DEPTH) != SUCCESS)
+			{
+				rings.reset();
+				break;
+			}
+		}
+	}
+	return SUCCESS;
+}
+
+ErrorCode FileBackend::close()
+{
+	rings.reset();
+	if (mapping != nullptr)
+	{
+		munmap(mapping, mappingSize);
+		mapping = nullptr;
+		mappingSize = 0;
+	}
+	int closingFd = fd;
+	fd = -1;
+	if (::close(closingFd) < 0)
+	{
+		return ERROR_CLOSE_DEVICE_FAIL;
+	}
+	return SUCCESS;
+}
+
+void FileBackend::setIoUring(bool enabled)
+{
+	ioUringRequested = enabled;
+}
+
+bool FileBackend::isIoUringEnabled() const
+{
+	return rings != nullptr;
+}
+
+void FileBackend::setDirectIO(bool enabled)
+{
+	directIORequested = enabled;
+}
+
+bool FileBackend::isDirectIOEnabled() const
+{
+	return directIOAlignment != 0;
+}
+
+void FileBackend::setBlockSize(uint32_t size)
+{
+	if (directIOAlignment == 0 || size % directIOAlignment == 0)
+	{
+		return;
+	}
+	int buffered = ::open(devicePath.c_str(), O_RDWR);
+	if (buffered < 0)
+	{
+		return;
+	}
+	if (dup2(buffered, fd) >= 0)
+	{
+		directIOAlignment = 0;
+	}
+	::close(buffered);
+}
+
+void FileBackend::setMmap(bool enabled)
+{
+	mmapRequested = enabled;
+}
+
+bool FileBackend::isMmapEnabled() const
+{
+	return mapping != nullptr;
+}
+
+void FileBackend::mapDevice()
+{
+	struct stat st;
+	if (fstat(fd, &st) < 0 || !S_ISREG(st.st_mode) || st.st_size == 0)
+	{
+		return;
+	}
+	void *address = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (address == MAP_FAILED)
+	{
+		return;
+	}
+	mapping = static_cast<uint8_t*>(address);
+	mappingSize = st.st_size;
+}
+
+uint32_t FileBackend::probeDirectIOAlignment()
+{
+	uint8_t *buffer = directIOBuffer();
+	if (buffer == nullptr)
+	{
+		return 0;
+	}
+	for (uint32_t alignment = DIRECT_IO_MIN_ALIGNMENT; alignment <= DIRECT_IO_MAX_ALIGNMENT; alignment *= 2)
+	{
+		if (pread(fd, buffer, alignment, alignment) == static_cast<ssize_t>(alignment))
+		{
+			return alignment;
+		}
+	}
+	return 0;
+}
+
+bool FileBackend::isDirectIOAligned(uint64_t offset, const void* buffer, size_t size) const
+{
+	if (directIOAlignment == 0)
+	{
+		return true;
+	}
+	return offset % directIOAlignment == 0 && size % directIOAlignment == 0 && reinterpret_cast<uintptr_t>(buffer) % directIOAlignment == 0;
+}
+
+uint8_t *FileBackend::memory(uint64_t offset, size_t size)
+{
+	if (mapping == nullptr || offset + size > mappingSize)
+	{
+		return nullptr;
+	}
+	return mapping + offset;
+}
+
+bool FileBackend::isMemoryBacked() const
+{
+	return mapping != nullptr;
+}
+
+ErrorCode FileBackend::read(uint64_t offset, void* buffer, size_t size)
+{
+	if (size == 0)
+	{
+		return SUCCESS;
+	}
+	if (mapping != nullptr)
+	{
+		if (offset + size > mappingSize)
+		{
+			return ERROR_READ_FAIL;
+		}
+		memcpy(buffer, mapping + offset, size);
+		return SUCCESS;
+	}
+	if (!isDirectIOAligned(offset, buffer, size))
+	{
+		return readBounced(offset, buffer, size);
+	}
+	if (readFully(offset, buffer, size) != size)
+	{
+		return ERROR_READ_FAIL;
+	}
+	return SUCCESS;
+}
+
+size_t FileBackend::readFully(uint64_t offset, void* buffer, size_t size)
+{
+	ssize_t result = pread(fd, buffer, size, offset);
+	int retries = 0;
+	size_t nowCount = result > 0 ? static_cast<size_t>(result) : 0;
+	while ((result < 0 || nowCount < size) && retries < MAX_READ_RETRIES)
+	{
+		result = pread(fd, static_cast<uint8_t*>(buffer) + nowCount, size - nowCount, offset + nowCount);
+		if (result > 0)
+		{
+			nowCount += static_cast<size_t>(result);
+		}
+		retries++;
+	}
+	return nowCount;
+}
+
+ErrorCode FileBackend::readBounced(uint64_t offset, void* buffer, size_t size)
+{
+	uint8_t *bounce = directIOBuffer();
+	if (bounce == nullptr)
+	{
+		return ERROR_CANNOT_ALLOCATE_MEMORY;
+	}
+	uint64_t end = offset + size;
+	uint64_t alignedEnd = (end + directIOAlignment - 1) / directIOAlignment * directIOAlignment;
+	for (uint64_t windowStart = offset - offset % directIOAlignment; windowStart < end; windowStart += DIRECT_IO_BOUNCE_BYTES)
+	{
+		uint64_t windowEnd = std::min<uint64_t>(alignedEnd, windowStart + DIRECT_IO_BOUNCE_BYTES);
+		uint64_t copyStart = std::max(offset, windowStart);
+		uint64_t copyEnd = std::min(end, windowEnd);
+		if (readFully(windowStart, bounce, windowEnd - windowStart) < copyEnd - windowStart)
+		{
+			return ERROR_READ_FAIL;
+		}
+		memcpy(static_cast<uint8_t*>(buffer) + (copyStart - offset), bounce + (copyStart - windowStart), copyEnd - copyStart);
+	}
+	return SUCCESS;
+}
+
+size_t FileBackend::readVectorFully(uint64_t offset, const iovec *vectors, size_t count, size_t size)
+{
+	static thread_local std::vector<iovec> pending;
+	pending.assign(vectors, vectors + count);
+	size_t first = 0;
+	size_t nowCount = 0;
+	int retries = 0;
+	while (true)
+	{
+		ssize_t result = preadv(fd, pending.data() + first, static_cast<int>(pending.size() - first), offset + nowCount);
+		if (result > 0)
+		{
+			nowCount += static_cast<size_t>(result);
+			size_t consumed = static_cast<size_t>(result);
+			while (first < pending.size() && consumed >= pending[first].iov_len)
+			{
+				consumed -= pending[first].iov_len;
+				first++;
+			}
+			if (consumed > 0)
+			{
+				pending[first].iov_base = static_cast<uint8_t*>(pending[first].iov_base) + consumed;
+				pending[first].iov_len -= consumed;
+			}
+		}
+		if (nowCount >= size || retries >= MAX_READ_RETRIES)
+		{
+			break;
+		}
+		retries++;
+	}
+	return nowCount;
+}
+
+ErrorCode FileBackend::readVector(uint64_t offset, const iovec *vectors, size_t count, size_t size)
+{
+	bool aligned = mapping == nullptr && isDirectIOAligned(offset, nullptr, size);
+	for (size_t i = 0; i < count && aligned; i++)
+	{
+		aligned = isDirectIOAligned(0, vectors[i].iov_base, vectors[i].iov_len);
+	}
+	if (aligned)
+	{
+		if (readVectorFully(offset, vectors, count, size) != size)
+		{
+			return ERROR_READ_FAIL;
+		}
+		return SUCCESS;
+	}
+	for (size_t i = 0; i < count; i++)
+	{
+		ErrorCode err = read(offset, vectors[i].iov_base, vectors[i].iov_len);
+		if (err != SUCCESS)
+		{
+			return err;
+		}
+		offset += vectors[i].iov_len;
+	}
+	return SUCCESS;
+}
+
+ErrorCode FileBackend::readBatch(std::vector<IoUringRequest> &requests)
+{
+	bool batched = false;
+	bool aligned = true;
+	for (const IoUringRequest &request : requests)
+	{
+		aligned = aligned && isDirectIOAligned(request.offset, nullptr, request.size);
+		for (uint32_t i = 0; i < request.vectorCount && aligned; i++)
+		{
+			aligned = isDirectIOAligned(0, request.vectors[i].iov_base, request.vectors[i].iov_len);
+		}
+	}
+	if (rings != nullptr && requests.size() > 1 && aligned)
+	{
+		IoUring &ring = rings[std::hash<std::thread::id>()(std::this_thread::get_id()) % IO_URING_RINGS];
+		batched = ring.read(requests) == SUCCESS;
+	}
+	for (IoUringRequest &request : requests)
+	{
+		if (batched && request.result >= 0 && static_cast<uint32_t>(request.result) == request.size)
+		{
+			continue;
+		}
+		ErrorCode err = readVector(request.offset, request.vectors, request.vectorCount, request.size);
+		if (err != SUCCESS)
+		{
+			return err;
+		}
+	}
+	return SUCCESS;
+}
+
+ErrorCode FileBackend::write(uint64_t offset, const void* buffer, size_t size)
+{
+	if (size == 0)
+	{
+		return SUCCESS;
+	}
+	if (mapping != nullptr)
+	{
+		if (offset + size > mappingSize)
+		{
+			return ERROR_WRITE_FAIL;
+		}
+		memcpy(mapping + offset, buffer, size);
+		return SUCCESS;
+	}
+	if (!isDirectIOAligned(offset, buffer, size))
+	{
+		return writeBounced(offset, buffer, size);
+	}
+	if (writeFully(offset, buffer, size) != size)
+	{
+		return ERROR_WRITE_FAIL;
+	}
+	return SUCCESS;
+}
+
+size_t FileBackend::writeFully(uint64_t offset, const void* buffer, size_t size)
+{
+	ssize_t result = pwrite(fd, buffer, size, offset);
+	int retries = 0;
+	size_t nowCount = result > 0 ? static_cast<size_t>(result) : 0;
+	while ((result < 0 || nowCount < size) && retries < MAX_READ_RETRIES)
+	{
+		result = pwrite(fd, static_cast<const uint8_t*>(buffer) + nowCount, size - nowCount, offset + nowCount);
+		if (result > 0)
+		{
+			nowCount += static_cast<size_t>(result);
+		}
+		retries++;
+	}
+	return nowCount;
+}
+
+size_t FileBackend::writeVectorFully(uint64_t offset, const iovec *vectors, size_t count, size_t size)
+{
+	static thread_local std::vector<iovec> pending;
+	pending.assign(vectors, vectors + count);
+	size_t first = 0;
+	size_t nowCount = 0;
+	int retries = 0;
+	while (true)
+	{
+		ssize_t result = pwritev(fd, pending.data() + first, static_cast<int>(pending.size() - first), offset + nowCount);
+		if (result > 0)
+		{
+			nowCount += static_cast<size_t>(result);
+			size_t consumed = static_cast<size_t>(result);
+			while (first < pending.size() && consumed >= pending[first].iov_len)
+			{
+				consumed -= pending[first].iov_len;
+				first++;
+			}
+			if (consumed > 0)
+			{
+				pending[first].iov_base = static_cast<uint8_t*>(pending[first].iov_base) + consumed;
+				pending[first].iov_len -= consumed;
+			}
+		}
+		if (nowCount >= size || retries >= MAX_READ_RETRIES)
+		{
+			break;
+		}
+		retries++;
+	}
+	return nowCount;
+}
+
+ErrorCode FileBackend::writeVector(uint64_t offset, const iovec *vectors, size_t count, size_t size)
+{
+	bool aligned = mapping == nullptr && isDirectIOAligned(offset, nullptr, size);
+	for (size_t i = 0; i < count && aligned; i++)
+	{
+		aligned = isDirectIOAligned(0, vectors[i].iov_base, vectors[i].iov_len);
+	}
+	if (aligned)
+	{
+		if (writeVectorFully(offset, vectors, count, size) != size)
+		{
+			return ERROR_WRITE_FAIL;
+		}
+		return SUCCESS;
+	}
+	for (size_t i = 0; i < count; i++)
+	{
+		ErrorCode err = write(offset, vectors[i].iov_base, vectors[i].iov_len);
+		if (err != SUCCESS)
+		{
+			return err;
+		}
+		offset += vectors[i].iov_len;
+	}
+	return SUCCESS;
+}
+
+ErrorCode FileBackend::writeBounced(uint64_t offset, const void* buffer, size_t size)
+{
+	uint8_t *bounce = directIOBuffer();
+	if (bounce == nullptr)
+	{
+		return ERROR_CANNOT_ALLOCATE_MEMORY;
+	}
+	uint64_t end = offset + size;
+	uint64_t alignedEnd = (end + directIOAlignment - 1) / directIOAlignment * directIOAlignment;
+	for (uint64_t windowStart = offset - offset % directIOAlignment; windowStart < end; windowStart += DIRECT_IO_BOUNCE_BYTES)
+	{
+		uint64_t windowEnd = std::min<uint64_t>(alignedEnd, windowStart + DIRECT_IO_BOUNCE_BYTES);
+		uint64_t copyStart = std::max(offset, windowStart);
+		uint64_t copyEnd = std::min(end, windowEnd);
+		if (copyStart != windowStart || copyEnd != windowEnd)
+		{
+			size_t existing = readFully(windowStart, bounce, windowEnd - windowStart);
+			memset(bounce + existing, 0, windowEnd - windowStart - existing);
+		}
+		memcpy(bounce + (copyStart - windowStart), static_cast<const uint8_t*>(buffer) + (copyStart - offset), copyEnd - copyStart);
+		if (writeFully(windowStart, bounce, windowEnd - windowStart) != windowEnd - windowStart)
+		{
+			return ERROR_WRITE_FAIL;
+		}
+	}
+	return SUCCESS;
+}
+
+ErrorCode FileBackend::sync(bool dataOnly)
+{
+	if (mapping != nullptr && msync(mapping, mappingSize, MS_SYNC) < 0)
+	{
+		return ERROR_WRITE_FAIL;
+	}
+	if ((dataOnly ? ::fdatasync(fd) : ::fsync(fd)) < 0)
+	{
+		return ERROR_WRITE_FAIL;
+	}
+	return SUCCESS;
+}
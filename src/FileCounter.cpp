@@ -2,21 +2,38 @@
 
 void FileCounter::add(Ino ino)
 {
+	std::lock_guard<std::mutex> lock(mutex);
 	++counter[ino];
 }
 
-void FileCounter::remove(Ino ino)
+void FileCounter::remove(Ino ino, uint64_t count)
 {
+	std::lock_guard<std::mutex> lock(mutex);
 	auto it = counter.find(ino);
 	if (it != counter.end())
 	{
-		if (--(it->second) == 0)
+		if (count >= it->second)
 			counter.erase(it);
+		else
+			it->second -= count;
 	}
 }
 
 bool FileCounter::empty(Ino ino) const
 {
+	std::lock_guard<std::mutex> lock(mutex);
 	auto it = counter.find(ino);
 	return it == counter.end() || it->second == 0;
+}
+
+std::vector<Ino> FileCounter::inodes() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	std::vector<Ino> result;
+	result.reserve(counter.size());
+	for (const auto &entry : counter)
+	{
+		result.push_back(entry.first);
+	}
+	return result;
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include "Utils.h"
 #include <ctime>
 #include <cstring>
+#include <sys/stat.h>
 
 void FileCreator::setInodeReader(InodeReader &inodeReader)
 {
@@ -23,11 +24,21 @@ void FileCreator::setDirWriter(DirWriter &dirWriter)
 	this->dirWriter = &dirWriter;
 }
 
+void FileCreator::setDirIndex(DirIndex &dirIndex)
+{
+	this->dirIndex = &dirIndex;
+}
+
 void FileCreator::setImapAllocator(Allocator &imapAllocator)
 {
 	this->imapAllocator = &imapAllocator;
 }
 
+void FileCreator::setInodesPerBlock(uint32_t inodesPerBlock)
+{
+	this->inodesPerBlock = inodesPerBlock;
+}
+
 Ino FileCreator::createFile(Ino parentInodeNumber, const std::string &name, uint16_t mode, uint16_t uid, uint16_t gid, ErrorCode &outError)
 {
 	if (name.empty() || name.length() > MINIX3_DIR_NAME_MAX)
@@ -47,21 +58,27 @@ Ino FileCreator::createFile(Ino parentInodeNumber, const std::string &name, uint
 		outError = ERROR_NOT_DIRECTORY;
 		return 0;
 	}
-	std::vector<DirEntry> entries = dirReader->readDir(parentInodeNumber, 0, parentInode.i_size / sizeof(DirEntryOnDisk), err);
-	if (err != SUCCESS)
+	DirIndexEntry existingEntry;
+	err = dirIndex->find(parentInodeNumber, name, existingEntry);
+	if (err == SUCCESS)
+	{
+		outError = ERROR_FILE_NAME_EXISTS;
+		return 0;
+	}
+	if (err != ERROR_FILE_NOT_FOUND)
 	{
 		outError = err;
 		return 0;
 	}
-	for (const DirEntry &entry : entries)
+	Ino newInodeNumber;
+	if (S_ISDIR(mode))
+	{
+		newInodeNumber = imapAllocator->allocateSpread(parentInodeNumber == MINIX3_ROOT_INODE ? 0 : parentInodeNumber, err);
+	}
+	else
 	{
-		if (char60ToString(entry.raw.d_name) == name)
-		{
-			outError = ERROR_FILE_NAME_EXISTS;
-			return 0;
-		}
+		newInodeNumber = imapAllocator->allocateBmap(parentInodeNumber - (parentInodeNumber - 1) % inodesPerBlock, err);
 	}
-	Ino newInodeNumber = imapAllocator->allocateBmap(err);
 	if (err != SUCCESS)
 	{
 		outError = err;
@@ -10,11 +10,6 @@ void FileDeleter::setFileWriter(FileWriter &fileWriter)
 	this->fileWriter = &fileWriter;
 }
 
-void FileDeleter::setFileCounter(FileCounter &fileCounter)
-{
-	this->fileCounter = &fileCounter;
-}
-
 void FileDeleter::setDirReader(DirReader &dirReader)
 {
 	this->dirReader = &dirReader;
@@ -80,9 +75,9 @@ ErrorCode FileDeleter::unlinkFile(Ino parentInodeNumber, uint32_t idx)
 	{
 		return err;
 	}
-	if (inode.i_nlinks == 0 && fileCounter->empty(inodeNumber))
+	if (inode.i_nlinks == 0)
 	{
-		return deleteFile(inodeNumber);
+		orphans.push_back(inodeNumber);
 	}
 	return SUCCESS;
 }
\ No newline at end of file
@@ -44,7 +44,34 @@ bool FileMapper::isIndirectBlockEmpty(const IndirectBlock &block) const
 	return true;
 }
 
-ErrorCode FileMapper::mapLogicalToPhysical(MinixInode3 &inode, Zno logicalZoneIndex, Zno &outPhysicalZoneIndex, bool allocateIfNotMapped, bool freeIfMapped, bool allocateWriteZero)
+SequentialZoneReservation::~SequentialZoneReservation()
+{
+	release();
+}
+
+ErrorCode SequentialZoneReservation::release()
+{
+	ErrorCode err = SUCCESS;
+	for (; next < end && err == SUCCESS; next++)
+	{
+		err = zmapAllocator->freeBmap(next);
+	}
+	next = 0;
+	end = 0;
+	wanted = 0;
+	return err;
+}
+
+const uint8_t *FileMapper::zeroZoneData()
+{
+	if (zeroZone.size() != static_cast<size_t>(blocksPerZone) * blockSize)
+	{
+		zeroZone.assign(static_cast<size_t>(blocksPerZone) * blockSize, 0);
+	}
+	return zeroZone.data();
+}
+
+ErrorCode FileMapper::mapLogicalToPhysical(MinixInode3 &inode, Zno logicalZoneIndex, Zno &outPhysicalZoneIndex, bool allocateIfNotMapped, bool freeIfMapped, bool allocateWriteZero, SequentialZoneReservation *reservation)
 {
 	if (blockDevice == nullptr || zonesPerIndirectBlock == 0 || blocksPerZone == 0)
 	{
@@ -54,20 +81,60 @@ ErrorCode FileMapper::mapLogicalToPhysical(MinixInode3 &inode, Zno logicalZoneIn
 	{
 		return ERROR_FS_BROKEN;
 	}
+	if (!allocateIfNotMapped && !freeIfMapped)
+	{
+		return lookupMapped(inode, logicalZoneIndex, outPhysicalZoneIndex);
+	}
 	auto allocateZone = [&](Zno &outZone) -> ErrorCode
 	{
 		ErrorCode err = SUCCESS;
-		outZone = zmapAllocator->allocateBmap(err);
+		outZone = zmapAllocator->allocateBmap(reservation == nullptr ? 0 : reservation->goal, err);
 		if (err != SUCCESS)
 		{
 			return err;
 		}
+		if (reservation != nullptr)
+		{
+			reservation->goal = outZone + 1;
+		}
 		if (allocateWriteZero)
 		{
-			err = blockDevice->writeZone(outZone, std::vector<uint8_t>(blocksPerZone * blockSize, 0).data());
+			err = blockDevice->writeZone(outZone, zeroZoneData());
 		}
 		return err;
 	};
+	auto allocateDataZone = [&](Zno &outZone) -> ErrorCode
+	{
+		if (reservation == nullptr)
+		{
+			return allocateZone(outZone);
+		}
+		if (reservation->next == reservation->end && reservation->wanted >= ALLOCATE_RUN_MIN_ZONES)
+		{
+			ErrorCode err = SUCCESS;
+			uint32_t length = 0;
+			reservation->next = zmapAllocator->allocateRun(reservation->wanted, reservation->goal, length, err);
+			if (err != SUCCESS)
+			{
+				reservation->next = 0;
+				reservation->end = 0;
+				return err;
+			}
+			reservation->end = reservation->next + length;
+		}
+		if (reservation->next == reservation->end)
+		{
+			return allocateZone(outZone);
+		}
+		outZone = reservation->next++;
+		reservation->goal = reservation->next;
+		reservation->wanted = reservation->wanted > 0 ? reservation->wanted - 1 : 0;
+		if (allocateWriteZero)
+		{
+			return blockDevice->writeZone(outZone, zeroZoneData());
+		}
+		return SUCCESS;
+	};
 	auto initIndirectBlock = [&](Zno zoneNumber) -> ErrorCode
 	{
 		IndirectBlock emptyBlock{};
@@ -79,7 +146,7 @@ ErrorCode FileMapper::mapLogicalToPhysical(MinixInode3 &inode, Zno logicalZoneIn
 		if (allocateIfNotMapped && inode.i_zone[logicalZoneIndex] == 0)
 		{
 			Zno newZone = 0;
-			ErrorCode err = allocateZone(newZone);
+			ErrorCode err = allocateDataZone(newZone);
 			if (err != SUCCESS)
 			{
 				return err;
@@ -134,7 +201,7 @@ ErrorCode FileMapper::mapLogicalToPhysical(MinixInode3 &inode, Zno logicalZoneIn
 		uint32_t dataZoneIndex = logicalZoneIndex % zonesPerIndirectBlock;
 		if (allocateIfNotMapped && singleIndirectBlock.zones[dataZoneIndex] == 0)
 		{
-			err = allocateZone(singleIndirectBlock.zones[dataZoneIndex]);
+			err = allocateDataZone(singleIndirectBlock.zones[dataZoneIndex]);
 			if (err != SUCCESS)
 			{
 				return err;
@@ -244,7 +311,7 @@ ErrorCode FileMapper::mapLogicalToPhysical(MinixInode3 &inode, Zno logicalZoneIn
 		uint32_t dataZoneIndex = logicalZoneIndex % zonesPerIndirectBlock;
 		if (allocateIfNotMapped && singleIndirectBlock.zones[dataZoneIndex] == 0)
 		{
-			err = allocateZone(singleIndirectBlock.zones[dataZoneIndex]);
+			err = allocateDataZone(singleIndirectBlock.zones[dataZoneIndex]);
 			if (err != SUCCESS)
 			{
 				return err;
@@ -407,7 +474,7 @@ ErrorCode FileMapper::mapLogicalToPhysical(MinixInode3 &inode, Zno logicalZoneIn
 		{
 			if (allocateIfNotMapped)
 			{
-				err = allocateZone(singleIndirectBlock.zones[dataZoneIndex]);
+				err = allocateDataZone(singleIndirectBlock.zones[dataZoneIndex]);
 				if (err != SUCCESS)
 				{
 					return err;
@@ -493,6 +560,44 @@ ErrorCode FileMapper::mapLogicalToPhysical(MinixInode3 &inode, Zno logicalZoneIn
 	return ERROR_INVALID_FILE_OFFSET;
 }
 
+ErrorCode FileMapper::lookupMapped(const MinixInode3 &inode, Zno logicalZoneIndex, Zno &outPhysicalZoneIndex)
+{
+	if (logicalZoneIndex < MINIX3_DIRECT_ZONES)
+	{
+		outPhysicalZoneIndex = inode.i_zone[logicalZoneIndex];
+		return SUCCESS;
+	}
+	uint64_t index = logicalZoneIndex - MINIX3_DIRECT_ZONES;
+	uint64_t zonesCovered = zonesPerIndirectBlock;
+	for (uint32_t level = 0; level < 3; level++)
+	{
+		if (index < zonesCovered)
+		{
+			Zno zone = inode.i_zone[MINIX3_SINGLE_INDIRECT_ZONE_INDEX + level];
+			for (uint64_t divisor = zonesCovered / zonesPerIndirectBlock; zone != 0; divisor /= zonesPerIndirectBlock)
+			{
+				uint32_t pin;
+				const uint8_t *block = blockDevice->pinBlock(zone * blocksPerZone, pin);
+				if (block == nullptr)
+				{
+					return ERROR_READ_FAIL;
+				}
+				zone = reinterpret_cast<const IndirectBlock*>(block)->zones[index / divisor % zonesPerIndirectBlock];
+				blockDevice->unpinBlock(pin);
+				if (divisor == 1)
+				{
+					break;
+				}
+			}
+			outPhysicalZoneIndex = zone;
+			return SUCCESS;
+		}
+		index -= zonesCovered;
+		zonesCovered *= zonesPerIndirectBlock;
+	}
+	return ERROR_INVALID_FILE_OFFSET;
+}
+
 ErrorCode FileMapper::freeLogicalZone(MinixInode3 &inode, Zno logicalZoneIndex)
 {
 	Zno physicalZoneIndex;
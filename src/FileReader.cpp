@@ -1,6 +1,7 @@
 #include "FileReader.h"
 #include "IndirectBlock.h"
 #include <cstring>
+#include <vector>
 
 void FileReader::setBlockDevice(BlockDevice &blockDevice)
 {
@@ -32,10 +33,15 @@ ErrorCode FileReader::readFile(const MinixInode3 &inode, uint8_t *buffer, uint32
 		return ERROR_INVALID_FILE_OFFSET;
 	}
 	MinixInode3 inodeForMap = inode;
+	static thread_local std::vector<ZoneRun> zoneRuns;
+	zoneRuns.clear();
 	Zno startZoneIndex = offset / layout->zoneSize;
 	Zno endZoneIndex = (offset + sizeToRead - 1) / layout->zoneSize;
 	for (Zno zoneIndex = startZoneIndex; zoneIndex <= endZoneIndex; zoneIndex++)
 	{
+		uint32_t zoneOffset = zoneIndex == startZoneIndex ? offset % layout->zoneSize : 0;
+		uint32_t bufferOffset = zoneIndex == startZoneIndex ? 0 : (zoneIndex - startZoneIndex) * layout->zoneSize - (offset % layout->zoneSize);
+		uint32_t copySize = std::min(layout->zoneSize - zoneOffset, sizeToRead - bufferOffset);
 		Zno physicalZoneIndex;
 		ErrorCode err = fileMapper->mapLogicalToPhysical(inodeForMap, zoneIndex, physicalZoneIndex);
 		if (err != SUCCESS)
@@ -46,8 +52,7 @@ ErrorCode FileReader::readFile(const MinixInode3 &inode, uint8_t *buffer, uint32
 		{
 			if (inode.isRegularFile())
 			{
-				uint32_t readSize = zoneIndex == startZoneIndex ? std::min(sizeToRead, layout->zoneSize - (offset % layout->zoneSize)) : zoneIndex == endZoneIndex ? (offset + sizeToRead - 1) % layout->zoneSize + 1 : layout->zoneSize;
-				memset(zoneIndex == startZoneIndex ? buffer : buffer + (zoneIndex - startZoneIndex) * layout->zoneSize - (offset % layout->zoneSize), 0, readSize);
+				memset(buffer + bufferOffset, 0, copySize);
 				continue;
 			}
 			else
@@ -55,32 +60,13 @@ ErrorCode FileReader::readFile(const MinixInode3 &inode, uint8_t *buffer, uint32
 				return ERROR_FS_BROKEN;
 			}
 		}
-		if (zoneIndex == startZoneIndex)
+		uint64_t zoneStart = static_cast<uint64_t>(physicalZoneIndex) * layout->zoneSize + zoneOffset;
+		if (!zoneRuns.empty() && zoneRuns.back().offset + zoneRuns.back().size == zoneStart && zoneRuns.back().buffer + zoneRuns.back().size == buffer + bufferOffset)
 		{
-			err = blockDevice->readZone(physicalZoneIndex, zoneBuffer);
-			if (err != SUCCESS)
-			{
-				return err;
-			}
-			memcpy(buffer, zoneBuffer + (offset % layout->zoneSize), std::min(sizeToRead, layout->zoneSize - (offset % layout->zoneSize)));
-		}
-		else if (zoneIndex == endZoneIndex)
-		{
-			err = blockDevice->readZone(physicalZoneIndex, zoneBuffer);
-			if (err != SUCCESS)
-			{
-				return err;
-			}
-			memcpy(buffer + (zoneIndex - startZoneIndex) * layout->zoneSize - (offset % layout->zoneSize), zoneBuffer, (offset + sizeToRead - 1) % layout->zoneSize + 1);
-		}
-		else
-		{
-			err = blockDevice->readZone(physicalZoneIndex, buffer + (zoneIndex - startZoneIndex) * layout->zoneSize - (offset % layout->zoneSize));
-			if (err != SUCCESS)
-			{
-				return err;
-			}
+			zoneRuns.back().size += copySize;
+			continue;
 		}
+		zoneRuns.push_back(ZoneRun{zoneStart, buffer + bufferOffset, copySize});
 	}
-	return SUCCESS;
+	return blockDevice->readRuns(zoneRuns);
 }
\ No newline at end of file
@@ -1,6 +1,9 @@
 #include "FileWriter.h"
+#include "Constants.h"
 #include <cstring>
+#include <vector>
 #include <ctime>
+#include <algorithm>
 
 void FileWriter::setBlockDevice(BlockDevice &blockDevice)
 {
@@ -27,6 +30,16 @@ void FileWriter::setInodeWriter(InodeWriter &inodeWriter)
 	this->inodeWriter = &inodeWriter;
 }
 
+void FileWriter::setZmapAllocator(Allocator &zmapAllocator)
+{
+	this->zmapAllocator = &zmapAllocator;
+}
+
+void FileWriter::setOrderedData(bool enabled)
+{
+	orderedData = enabled;
+}
+
 ErrorCode FileWriter::writeFile(Ino inodeNumber, const uint8_t *data, uint32_t offset, uint32_t sizeToWrite)
 {
 	if (sizeToWrite == 0)
@@ -41,7 +54,30 @@ ErrorCode FileWriter::writeFile(Ino inodeNumber, const uint8_t *data, uint32_t o
 	}
 
 	Zno startZoneIndex = offset / layout->zoneSize;
+	static thread_local std::vector<ZoneWriteRun> zoneRuns;
+	static thread_local std::vector<ZoneWriteRun> dataRuns;
+	zoneRuns.clear();
+	dataRuns.clear();
+	const uint8_t *zeroZone = fileMapper->zeroZoneData();
 	Zno endZoneIndex = (offset + sizeToWrite - 1) / layout->zoneSize;
+	Zno mappedZones = (inodeForMap.i_size + layout->zoneSize - 1) / layout->zoneSize;
+	Zno firstNewZoneIndex = std::max(startZoneIndex, mappedZones);
+	SequentialZoneReservation reservation{zmapAllocator};
+	Zno goalIndex = std::min(startZoneIndex, mappedZones);
+	if (goalIndex > 0)
+	{
+		Zno previousZone = 0;
+		err = fileMapper->mapLogicalToPhysical(inodeForMap, goalIndex - 1, previousZone);
+		if (err != SUCCESS)
+		{
+			return err;
+		}
+		reservation.goal = previousZone == 0 ? 0 : previousZone + 1;
+	}
+	if (endZoneIndex >= firstNewZoneIndex && endZoneIndex - firstNewZoneIndex + 1 >= ALLOCATE_RUN_MIN_ZONES)
+	{
+		reservation.wanted = endZoneIndex - firstNewZoneIndex + 1;
+	}
 	for (Zno zoneIndex = startZoneIndex; zoneIndex <= endZoneIndex; zoneIndex++)
 	{
 		Zno physicalZoneIndex;
@@ -54,35 +90,71 @@ ErrorCode FileWriter::writeFile(Ino inodeNumber, const uint8_t *data, uint32_t o
 		{
 			writeZero = true;
 		}
-		ErrorCode err = fileMapper->mapLogicalToPhysical(inodeForMap, zoneIndex, physicalZoneIndex, true, false, writeZero);
+		bool freshZone = false;
+		if (orderedData)
+		{
+			ErrorCode err = fileMapper->mapLogicalToPhysical(inodeForMap, zoneIndex, physicalZoneIndex);
+			if (err != SUCCESS)
+			{
+				return err;
+			}
+			freshZone = physicalZoneIndex == 0;
+		}
+		ErrorCode err = fileMapper->mapLogicalToPhysical(inodeForMap, zoneIndex, physicalZoneIndex, true, false, writeZero && !freshZone, &reservation);
 		if (err != SUCCESS)
 		{
 			return err;
 		}
-		uint32_t writeSize = zoneIndex == startZoneIndex ? std::min(sizeToWrite, layout->zoneSize - (offset % layout->zoneSize)) : zoneIndex == endZoneIndex ? (offset + sizeToWrite - 1) % layout->zoneSize + 1 : layout->zoneSize;
-		if (writeSize == layout->zoneSize)
+		reservation.goal = physicalZoneIndex + 1;
+		if (freshZone && !zmapAllocator->isCommittedFree(physicalZoneIndex))
 		{
-			err = blockDevice->writeZone(physicalZoneIndex, data + (zoneIndex - startZoneIndex) * layout->zoneSize - (offset % layout->zoneSize));
-			if (err != SUCCESS)
+			freshZone = false;
+			if (writeZero)
 			{
-				return err;
+				err = blockDevice->writeZone(physicalZoneIndex, zeroZone);
+				if (err != SUCCESS)
+				{
+					return err;
+				}
 			}
 		}
+		uint32_t zoneOffset = zoneIndex == startZoneIndex ? offset % layout->zoneSize : 0;
+		uint32_t writeSize = zoneIndex == startZoneIndex ? std::min(sizeToWrite, layout->zoneSize - (offset % layout->zoneSize)) : zoneIndex == endZoneIndex ? (offset + sizeToWrite - 1) % layout->zoneSize + 1 : layout->zoneSize;
+		uint64_t zoneStart = static_cast<uint64_t>(physicalZoneIndex) * layout->zoneSize + zoneOffset;
+		const uint8_t *source = zoneIndex == startZoneIndex ? data : data + (zoneIndex - startZoneIndex) * layout->zoneSize - (offset % layout->zoneSize);
+		std::vector<ZoneWriteRun> &runs = freshZone ? dataRuns : zoneRuns;
+		if (freshZone && zoneOffset > 0)
+		{
+			runs.push_back(ZoneWriteRun{zoneStart - zoneOffset, zeroZone, zoneOffset});
+		}
+		if (!runs.empty() && runs.back().offset + runs.back().size == zoneStart && runs.back().buffer + runs.back().size == source)
+		{
+			runs.back().size += writeSize;
+		}
 		else
 		{
-			err = blockDevice->readZone(physicalZoneIndex, zoneBuffer);
-			if (err != SUCCESS)
-			{
-				return err;
-			}
-			memcpy(zoneBuffer + (zoneIndex == startZoneIndex ? (offset % layout->zoneSize) : 0), zoneIndex == startZoneIndex ? data : data + (zoneIndex - startZoneIndex) * layout->zoneSize - (offset % layout->zoneSize), writeSize);
-			err = blockDevice->writeZone(physicalZoneIndex, zoneBuffer);
-			if (err != SUCCESS)
-			{
-				return err;
-			}
+			runs.push_back(ZoneWriteRun{zoneStart, source, writeSize});
+		}
+		if (freshZone && zoneOffset + writeSize < layout->zoneSize)
+		{
+			runs.push_back(ZoneWriteRun{zoneStart + writeSize, zeroZone, layout->zoneSize - zoneOffset - writeSize});
 		}
 	}
+	err = reservation.release();
+	if (err != SUCCESS)
+	{
+		return err;
+	}
+	err = blockDevice->writeRunsInPlace(dataRuns);
+	if (err != SUCCESS)
+	{
+		return err;
+	}
+	err = blockDevice->writeRuns(zoneRuns);
+	if (err != SUCCESS)
+	{
+		return err;
+	}
 	inodeForMap.i_size = std::max(inodeForMap.i_size, offset + sizeToWrite);
 	inodeForMap.i_mtime = static_cast<uint32_t>(time(nullptr));
 	inodeForMap.i_ctime = inodeForMap.i_mtime;
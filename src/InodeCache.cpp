@@ -0,0 +1,333 @@
+#include "InodeCache.h"
+#include "Constants.h"
+#include <cstring>
+#include <map>
+#include <vector>
+
+void InodeCache::setLayout(Layout &layout)
+{
+	this->layout = &layout;
+}
+
+void InodeCache::setBlockDevice(BlockDevice &blockDevice)
+{
+	this->blockDevice = &blockDevice;
+}
+
+void InodeCache::setCapacity(uint32_t capacity)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	this->capacity = capacity;
+	evict();
+}
+
+bool InodeCache::ownsTransaction() const
+{
+	return isInTransaction && transactionOwner == std::this_thread::get_id();
+}
+
+InodeCacheEntry *InodeCache::lookup(Ino inodeNumber, std::unique_lock<std::mutex> &lock, ErrorCode &outError)
+{
+	auto it = entries.find(inodeNumber);
+	if (it != entries.end())
+	{
+		if (it->second.refCount == 0)
+		{
+			lru.splice(lru.begin(), lru, it->second.lruPosition);
+		}
+		outError = SUCCESS;
+		return &it->second;
+	}
+	InodeOffset inodeOffset = layout->inodeOffset(inodeNumber, outError);
+	if (outError != SUCCESS)
+	{
+		return nullptr;
+	}
+	MinixInode3 inode;
+	const uint8_t *mappedBlock = blockDevice->peekBlock(inodeOffset.blockNumber);
+	if (mappedBlock != nullptr)
+	{
+		memcpy(&inode, mappedBlock + inodeOffset.offsetInBlock, MINIX3_INODE_SIZE);
+		store(inodeNumber, inode);
+		return &entries.find(inodeNumber)->second;
+	}
+	uint8_t blockBuffer[MINIX3_MAX_BLOCK_SIZE];
+	lock.unlock();
+	outError = blockDevice->readBlock(inodeOffset.blockNumber, blockBuffer);
+	lock.lock();
+	if (outError != SUCCESS)
+	{
+		return nullptr;
+	}
+	it = entries.find(inodeNumber);
+	if (it != entries.end())
+	{
+		return &it->second;
+	}
+	memcpy(&inode, blockBuffer + inodeOffset.offsetInBlock, MINIX3_INODE_SIZE);
+	store(inodeNumber, inode);
+	return &entries.find(inodeNumber)->second;
+}
+
+void InodeCache::store(Ino inodeNumber, const MinixInode3 &inode)
+{
+	auto it = entries.find(inodeNumber);
+	if (it != entries.end())
+	{
+		it->second.inode = inode;
+		return;
+	}
+	lru.push_front(inodeNumber);
+	entries[inodeNumber] = InodeCacheEntry{inode, 0, lru.begin()};
+	evict();
+}
+
+void InodeCache::evict()
+{
+	while (entries.size() > capacity && lru.size() > 1)
+	{
+		entries.erase(lru.back());
+		lru.pop_back();
+	}
+}
+
+ErrorCode InodeCache::writeBack(const std::unordered_map<Ino, MinixInode3> &inodes)
+{
+	std::map<Bno, std::vector<std::pair<uint32_t, const MinixInode3*>>> inodesOfBlock;
+	for (const auto &[inodeNumber, inode] : inodes)
+	{
+		ErrorCode err;
+		InodeOffset inodeOffset = layout->inodeOffset(inodeNumber, err);
+		if (err != SUCCESS)
+		{
+			return err;
+		}
+		inodesOfBlock[inodeOffset.blockNumber].emplace_back(inodeOffset.offsetInBlock, &inode);
+	}
+	uint8_t blockBuffer[MINIX3_MAX_BLOCK_SIZE];
+	for (const auto &[blockNumber, blockInodes] : inodesOfBlock)
+	{
+		ErrorCode err = blockDevice->readBlock(blockNumber, blockBuffer);
+		if (err != SUCCESS)
+		{
+			return err;
+		}
+		for (const auto &[offsetInBlock, inode] : blockInodes)
+		{
+			memcpy(blockBuffer + offsetInBlock, inode, MINIX3_INODE_SIZE);
+		}
+		err = blockDevice->writeBlock(blockNumber, blockBuffer);
+		if (err != SUCCESS)
+		{
+			return err;
+		}
+	}
+	return SUCCESS;
+}
+
+ErrorCode InodeCache::readInode(Ino inodeNumber, void* buffer)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	if (ownsTransaction())
+	{
+		auto it = transactionDirtyInodes.find(inodeNumber);
+		if (it != transactionDirtyInodes.end())
+		{
+			memcpy(buffer, &it->second, MINIX3_INODE_SIZE);
+			return SUCCESS;
+		}
+	}
+	ErrorCode err;
+	InodeCacheEntry *entry = lookup(inodeNumber, lock, err);
+	if (entry == nullptr)
+	{
+		return err;
+	}
+	memcpy(buffer, &entry->inode, MINIX3_INODE_SIZE);
+	return SUCCESS;
+}
+
+ErrorCode InodeCache::readInodes(const std::vector<Ino> &inodeNumbers, MinixInode3 *buffers)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	std::map<Bno, std::vector<std::pair<size_t, uint32_t>>> missesOfBlock;
+	bool transactional = ownsTransaction();
+	for (size_t i = 0; i < inodeNumbers.size(); i++)
+	{
+		Ino inodeNumber = inodeNumbers[i];
+		if (transactional)
+		{
+			auto it = transactionDirtyInodes.find(inodeNumber);
+			if (it != transactionDirtyInodes.end())
+			{
+				buffers[i] = it->second;
+				continue;
+			}
+		}
+		auto it = entries.find(inodeNumber);
+		if (it != entries.end())
+		{
+			if (it->second.refCount == 0)
+			{
+				lru.splice(lru.begin(), lru, it->second.lruPosition);
+			}
+			buffers[i] = it->second.inode;
+			continue;
+		}
+		ErrorCode err;
+		InodeOffset inodeOffset = layout->inodeOffset(inodeNumber, err);
+		if (err != SUCCESS)
+		{
+			return err;
+		}
+		missesOfBlock[inodeOffset.blockNumber].emplace_back(i, inodeOffset.offsetInBlock);
+	}
+	if (missesOfBlock.empty())
+	{
+		return SUCCESS;
+	}
+	lock.unlock();
+	uint8_t blockBuffer[MINIX3_MAX_BLOCK_SIZE];
+	for (const auto &[blockNumber, misses] : missesOfBlock)
+	{
+		const uint8_t *block = blockDevice->peekBlock(blockNumber);
+		if (block == nullptr)
+		{
+			ErrorCode err = blockDevice->readBlock(blockNumber, blockBuffer);
+			if (err != SUCCESS)
+			{
+				return err;
+			}
+			block = blockBuffer;
+		}
+		for (const auto &[i, offsetInBlock] : misses)
+		{
+			memcpy(&buffers[i], block + offsetInBlock, MINIX3_INODE_SIZE);
+		}
+	}
+	lock.lock();
+	for (const auto &[blockNumber, misses] : missesOfBlock)
+	{
+		for (const auto &[i, offsetInBlock] : misses)
+		{
+			auto it = entries.find(inodeNumbers[i]);
+			if (it != entries.end())
+			{
+				buffers[i] = it->second.inode;
+				continue;
+			}
+			store(inodeNumbers[i], buffers[i]);
+		}
+	}
+	return SUCCESS;
+}
+
+ErrorCode InodeCache::writeInode(Ino inodeNumber, const void* buffer)
+{
+	ErrorCode err;
+	layout->inodeOffset(inodeNumber, err);
+	if (err != SUCCESS)
+	{
+		return err;
+	}
+	MinixInode3 inode;
+	memcpy(&inode, buffer, MINIX3_INODE_SIZE);
+	std::lock_guard<std::mutex> lock(mutex);
+	if (ownsTransaction())
+	{
+		transactionDirtyInodes[inodeNumber] = inode;
+		return SUCCESS;
+	}
+	err = writeBack({{inodeNumber, inode}});
+	if (err != SUCCESS)
+	{
+		return err;
+	}
+	store(inodeNumber, inode);
+	return SUCCESS;
+}
+
+ErrorCode InodeCache::acquire(Ino inodeNumber)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	ErrorCode err;
+	InodeCacheEntry *entry = lookup(inodeNumber, lock, err);
+	if (entry == nullptr)
+	{
+		return err;
+	}
+	if (entry->refCount++ == 0)
+	{
+		lru.erase(entry->lruPosition);
+	}
+	return SUCCESS;
+}
+
+void InodeCache::release(Ino inodeNumber)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	auto it = entries.find(inodeNumber);
+	if (it == entries.end() || it->second.refCount == 0)
+	{
+		return;
+	}
+	if (--it->second.refCount == 0)
+	{
+		lru.push_front(inodeNumber);
+		it->second.lruPosition = lru.begin();
+		evict();
+	}
+}
+
+ErrorCode InodeCache::beginTransaction()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (isInTransaction)
+	{
+		return ERROR_IS_IN_TRANSACTION;
+	}
+	transactionOwner = std::this_thread::get_id();
+	isInTransaction = true;
+	return SUCCESS;
+}
+
+ErrorCode InodeCache::revertTransaction()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (!isInTransaction)
+	{
+		return ERROR_FS_BROKEN;
+	}
+	transactionDirtyInodes.clear();
+	isInTransaction = false;
+	return SUCCESS;
+}
+
+ErrorCode InodeCache::commitTransaction()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (!isInTransaction)
+	{
+		return ERROR_FS_BROKEN;
+	}
+	ErrorCode err = writeBack(transactionDirtyInodes);
+	if (err != SUCCESS)
+	{
+		return err;
+	}
+	for (const auto &[inodeNumber, inode] : transactionDirtyInodes)
+	{
+		store(inodeNumber, inode);
+	}
+	transactionDirtyInodes.clear();
+	isInTransaction = false;
+	return SUCCESS;
+}
+
+void InodeCache::clear()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	entries.clear();
+	lru.clear();
+	transactionDirtyInodes.clear();
+}
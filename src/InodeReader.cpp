@@ -9,38 +9,19 @@ void InodeReader::setLayout(Layout &layout)
 	this->layout = &layout;
 }
 
-void InodeReader::setBlockDevice(BlockDevice &blockDevice)
+void InodeReader::setInodeCache(InodeCache &inodeCache)
 {
-	this->blockDevice = &blockDevice;
+	this->inodeCache = &inodeCache;
 }
 
 ErrorCode InodeReader::readInode(Ino inodeNumber, void* buffer)
 {
-	ErrorCode err;
-	InodeOffset inodeOffset = layout->inodeOffset(inodeNumber, err);
-	if (err != SUCCESS)
-	{
-		return err;
-	}
-	err = blockDevice->readBlock(inodeOffset.blockNumber, blockBuffer);
-	if (err != SUCCESS)
-	{
-		return err;
-	}
-	memcpy(buffer, blockBuffer + inodeOffset.offsetInBlock, MINIX3_INODE_SIZE);
-	return SUCCESS;
+	return inodeCache->readInode(inodeNumber, buffer);
 }
 
-struct stat InodeReader::readStat(Ino inodeNumber, ErrorCode &outError)
+struct stat InodeReader::inodeToStat(Ino inodeNumber, const MinixInode3 &inode)
 {
 	struct stat st{};
-	MinixInode3 inode;
-	ErrorCode err = readInode(inodeNumber, &inode);
-	if (err != SUCCESS)
-	{
-		outError = err;
-		return {};
-	}
 	st.st_ino = inodeNumber;
 	st.st_mode = inode.i_mode;
 	st.st_size = inode.i_size;
@@ -54,6 +35,34 @@ struct stat InodeReader::readStat(Ino inodeNumber, ErrorCode &outError)
 	st.st_rdev = 0;
 	st.st_dev = 0;
 	st.st_blksize = layout->blockSize;
-	outError = SUCCESS;
 	return st;
+}
+
+struct stat InodeReader::readStat(Ino inodeNumber, ErrorCode &outError)
+{
+	MinixInode3 inode;
+	ErrorCode err = readInode(inodeNumber, &inode);
+	if (err != SUCCESS)
+	{
+		outError = err;
+		return {};
+	}
+	outError = SUCCESS;
+	return inodeToStat(inodeNumber, inode);
+}
+
+ErrorCode InodeReader::readStats(const std::vector<Ino> &inodeNumbers, std::vector<struct stat> &outStats)
+{
+	std::vector<MinixInode3> inodes(inodeNumbers.size());
+	ErrorCode err = inodeCache->readInodes(inodeNumbers, inodes.data());
+	if (err != SUCCESS)
+	{
+		return err;
+	}
+	outStats.resize(inodeNumbers.size());
+	for (size_t i = 0; i < inodeNumbers.size(); i++)
+	{
+		outStats[i] = inodeToStat(inodeNumbers[i], inodes[i]);
+	}
+	return SUCCESS;
 }
\ No newline at end of file
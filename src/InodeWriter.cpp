@@ -1,33 +1,11 @@
 #include "InodeWriter.h"
-#include "Constants.h"
-#include "Inode.h"
-#include <cstring>
-#include <sys/stat.h>
 
-void InodeWriter::setLayout(Layout &layout)
+void InodeWriter::setInodeCache(InodeCache &inodeCache)
 {
-	this->layout = &layout;
-}
-
-void InodeWriter::setBlockDevice(BlockDevice &blockDevice)
-{
-	this->blockDevice = &blockDevice;
+	this->inodeCache = &inodeCache;
 }
 
 ErrorCode InodeWriter::writeInode(Ino inodeNumber, void* buffer)
 {
-	ErrorCode err;
-	InodeOffset inodeOffset = layout->inodeOffset(inodeNumber, err);
-	if (err != SUCCESS)
-	{
-		return err;
-	}
-	err = blockDevice->readBlock(inodeOffset.blockNumber, blockBuffer);
-	if (err != SUCCESS)
-	{
-		return err;
-	}
-	memcpy(static_cast<uint8_t*>(blockBuffer) + inodeOffset.offsetInBlock, buffer, MINIX3_INODE_SIZE);
-	err = blockDevice->writeBlock(inodeOffset.blockNumber, blockBuffer);
-	return err;
+	return inodeCache->writeInode(inodeNumber, buffer);
 }
\ No newline at end of file
@@ -0,0 +1,179 @@
+#include "IoUring.h"
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+IoUring::IoUring(): ringFd(-1), entries(0), sqRing(MAP_FAILED), cqRing(MAP_FAILED), sqRingSize(0), cqRingSize(0), sqes(MAP_FAILED), sqesSize(0) {}
+
+IoUring::~IoUring()
+{
+	release();
+}
+
+ErrorCode IoUring::init(int fd, uint32_t queueDepth)
+{
+	release();
+	io_uring_params params;
+	memset(&params, 0, sizeof(params));
+	ringFd = static_cast<int>(syscall(__NR_io_uring_setup, queueDepth, &params));
+	if (ringFd < 0)
+	{
+		ringFd = -1;
+		return ERROR_OPEN_DEVICE_FAIL;
+	}
+	entries = params.sq_entries;
+	sqRingSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+	cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+	bool singleMmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+	if (singleMmap)
+	{
+		sqRingSize = std::max(sqRingSize, cqRingSize);
+		cqRingSize = sqRingSize;
+	}
+	sqRing = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+	if (sqRing == MAP_FAILED)
+	{
+		release();
+		return ERROR_OPEN_DEVICE_FAIL;
+	}
+	if (singleMmap)
+	{
+		cqRing = sqRing;
+	}
+	else
+	{
+		cqRing = mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+		if (cqRing == MAP_FAILED)
+		{
+			release();
+			return ERROR_OPEN_DEVICE_FAIL;
+		}
+	}
+	sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+	sqes = mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+	if (sqes == MAP_FAILED)
+	{
+		release();
+		return ERROR_OPEN_DEVICE_FAIL;
+	}
+	uint8_t *sq = static_cast<uint8_t*>(sqRing);
+	uint8_t *cq = static_cast<uint8_t*>(cqRing);
+	sqTail = reinterpret_cast<uint32_t*>(sq + params.sq_off.tail);
+	sqMask = reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_mask);
+	sqArray = reinterpret_cast<uint32_t*>(sq + params.sq_off.array);
+	cqHead = reinterpret_cast<uint32_t*>(cq + params.cq_off.head);
+	cqTail = reinterpret_cast<uint32_t*>(cq + params.cq_off.tail);
+	cqMask = reinterpret_cast<uint32_t*>(cq + params.cq_off.ring_mask);
+	cqes = cq + params.cq_off.cqes;
+	if (syscall(__NR_io_uring_register, ringFd, IORING_REGISTER_FILES, &fd, 1) < 0)
+	{
+		release();
+		return ERROR_OPEN_DEVICE_FAIL;
+	}
+	return SUCCESS;
+}
+
+void IoUring::release()
+{
+	if (sqes != MAP_FAILED)
+	{
+		munmap(sqes, sqesSize);
+		sqes = MAP_FAILED;
+	}
+	if (cqRing != MAP_FAILED && cqRing != sqRing)
+	{
+		munmap(cqRing, cqRingSize);
+	}
+	cqRing = MAP_FAILED;
+	if (sqRing != MAP_FAILED)
+	{
+		munmap(sqRing, sqRingSize);
+		sqRing = MAP_FAILED;
+	}
+	if (ringFd >= 0)
+	{
+		::close(ringFd);
+		ringFd = -1;
+	}
+	entries = 0;
+}
+
+bool IoUring::isEnabled() const
+{
+	return ringFd >= 0;
+}
+
+ErrorCode IoUring::enter(uint32_t toSubmit, uint32_t minComplete, uint32_t &outSubmitted)
+{
+	while (true)
+	{
+		long result = syscall(__NR_io_uring_enter, ringFd, toSubmit, minComplete, IORING_ENTER_GETEVENTS, nullptr, 0);
+		if (result >= 0)
+		{
+			outSubmitted = static_cast<uint32_t>(result);
+			return SUCCESS;
+		}
+		if (errno != EINTR && errno != EAGAIN && errno != EBUSY)
+		{
+			return ERROR_READ_FAIL;
+		}
+	}
+}
+
+ErrorCode IoUring::read(std::vector<IoUringRequest> &requests)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	io_uring_sqe *sqeArray = static_cast<io_uring_sqe*>(sqes);
+	io_uring_cqe *cqeArray = static_cast<io_uring_cqe*>(cqes);
+	size_t next = 0;
+	size_t completed = 0;
+	uint32_t inFlight = 0;
+	uint32_t queued = 0;
+	while (completed < requests.size())
+	{
+		uint32_t toSubmit = queued;
+		uint32_t tail = *sqTail;
+		while (next < requests.size() && inFlight + toSubmit < entries)
+		{
+			uint32_t index = tail & *sqMask;
+			io_uring_sqe &sqe = sqeArray[index];
+			memset(&sqe, 0, sizeof(io_uring_sqe));
+			sqe.opcode = IORING_OP_READV;
+			sqe.flags = IOSQE_FIXED_FILE;
+			sqe.fd = 0;
+			sqe.addr = reinterpret_cast<uint64_t>(requests[next].vectors);
+			sqe.len = requests[next].vectorCount;
+			sqe.off = requests[next].offset;
+			sqe.user_data = next;
+			sqArray[index] = index;
+			tail++;
+			toSubmit++;
+			next++;
+		}
+		__atomic_store_n(sqTail, tail, __ATOMIC_RELEASE);
+		uint32_t submitted;
+		ErrorCode err = enter(toSubmit, 1, submitted);
+		if (err != SUCCESS)
+		{
+			return err;
+		}
+		inFlight += submitted;
+		queued = toSubmit - submitted;
+		uint32_t head = *cqHead;
+		uint32_t cqTailValue = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+		while (head != cqTailValue)
+		{
+			io_uring_cqe &cqe = cqeArray[head & *cqMask];
+			requests[cqe.user_data].result = cqe.res;
+			head++;
+			inFlight--;
+			completed++;
+		}
+		__atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+	}
+	return SUCCESS;
+}
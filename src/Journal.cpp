@@ -0,0 +1,311 @@
+#include "Journal.h"
+#include <unistd.h>
+#include <fcntl.h>
+#include <cstring>
+#include <cstddef>
+#include "Constants.h"
+
+static uint64_t journalChecksum(const uint8_t *data, size_t size)
+{
+	uint64_t hash = 0xcbf29ce484222325ull;
+	size_t i = 0;
+	for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+	{
+		uint64_t word;
+		memcpy(&word, data + i, sizeof(uint64_t));
+		hash = (hash ^ word) * 0x100000001b3ull;
+		hash ^= hash >> 29;
+	}
+	for (; i < size; i++)
+	{
+		hash = (hash ^ data[i]) * 0x100000001b3ull;
+	}
+	return hash;
+}
+
+static bool readAll(int fd, uint64_t offset, void *buffer, size_t size)
+{
+	size_t nowCount = 0;
+	while (nowCount < size)
+	{
+		ssize_t result = pread(fd, static_cast<uint8_t*>(buffer) + nowCount, size - nowCount, offset + nowCount);
+		if (result <= 0)
+		{
+			return false;
+		}
+		nowCount += static_cast<size_t>(result);
+	}
+	return true;
+}
+
+static bool writeAll(int fd, uint64_t offset, const void *buffer, size_t size)
+{
+	size_t nowCount = 0;
+	while (nowCount < size)
+	{
+		ssize_t result = pwrite(fd, static_cast<const uint8_t*>(buffer) + nowCount, size - nowCount, offset + nowCount);
+		if (result <= 0)
+		{
+			return false;
+		}
+		nowCount += static_cast<size_t>(result);
+	}
+	return true;
+}
+
+Journal::Journal(): journalPath(""), fd(-1), fileSize(0), nextSequence(1), inPlaceDataUnsynced(false) {}
+
+Journal::~Journal()
+{
+	if (fd >= 0)
+	{
+		::close(fd);
+	}
+}
+
+void Journal::setPath(const std::string &path)
+{
+	journalPath = path;
+}
+
+bool Journal::isEnabled() const
+{
+	return fd >= 0;
+}
+
+ErrorCode Journal::open()
+{
+	if (journalPath.empty())
+	{
+		return SUCCESS;
+	}
+	fd = ::open(journalPath.c_str(), O_RDWR | O_CREAT, 0644);
+	if (fd < 0)
+	{
+		return ERROR_OPEN_DEVICE_FAIL;
+	}
+	off_t end = lseek(fd, 0, SEEK_END);
+	if (end < 0)
+	{
+		::close(fd);
+		fd = -1;
+		return ERROR_OPEN_DEVICE_FAIL;
+	}
+	fileSize = static_cast<uint64_t>(end);
+	pending.clear();
+	journaledBlocks.clear();
+	inPlaceDataUnsynced = false;
+	return SUCCESS;
+}
+
+ErrorCode Journal::replay(BlockBackend &backend)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	std::vector<uint8_t> record;
+	uint64_t offset = 0;
+	uint64_t expectedSequence = 0;
+	bool replayed = false;
+	while (offset + sizeof(JournalRecordHeader) <= fileSize)
+	{
+		JournalRecordHeader header;
+		if (!readAll(fd, offset, &header, sizeof(header)))
+		{
+			break;
+		}
+		if (header.magic != JOURNAL_MAGIC || header.blockSize < MINIX3_DEFAULT_BLOCK_SIZE || header.blockSize > MINIX3_MAX_BLOCK_SIZE || header.blockCount == 0)
+		{
+			break;
+		}
+		if (expectedSequence != 0 && header.sequence != expectedSequence)
+		{
+			break;
+		}
+		uint64_t recordSize = sizeof(JournalRecordHeader) + static_cast<uint64_t>(header.blockCount) * (sizeof(Bno) + header.blockSize);
+		if (offset + recordSize > fileSize)
+		{
+			break;
+		}
+		record.resize(recordSize);
+		if (!readAll(fd, offset, record.data(), recordSize))
+		{
+			break;
+		}
+		memset(record.data() + offsetof(JournalRecordHeader, checksum), 0, sizeof(uint64_t));
+		if (journalChecksum(record.data(), recordSize) != header.checksum)
+		{
+			break;
+		}
+		const uint8_t *numbers = record.data() + sizeof(JournalRecordHeader);
+		const uint8_t *data = numbers + static_cast<size_t>(header.blockCount) * sizeof(Bno);
+		for (uint32_t i = 0; i < header.blockCount; i++)
+		{
+			Bno blockNumber;
+			memcpy(&blockNumber, numbers + i * sizeof(Bno), sizeof(Bno));
+			ErrorCode err = backend.write(static_cast<uint64_t>(blockNumber) * header.blockSize, data + static_cast<size_t>(i) * header.blockSize, header.blockSize);
+			if (err != SUCCESS)
+			{
+				return err;
+			}
+		}
+		replayed = true;
+		expectedSequence = header.sequence + 1;
+		offset += recordSize;
+	}
+	if (expectedSequence != 0)
+	{
+		nextSequence = expectedSequence;
+	}
+	if (replayed)
+	{
+		ErrorCode err = backend.sync(false);
+		if (err != SUCCESS)
+		{
+			return err;
+		}
+	}
+	if (ftruncate(fd, 0) < 0 || ::fdatasync(fd) < 0)
+	{
+		return ERROR_WRITE_FAIL;
+	}
+	fileSize = 0;
+	return SUCCESS;
+}
+
+ErrorCode Journal::append(const TransactionWriteSet &writes, uint16_t blockSize)
+{
+	if (writes.size() == 0)
+	{
+		return SUCCESS;
+	}
+	std::lock_guard<std::mutex> lock(mutex);
+	size_t start = pending.size();
+	size_t recordSize = sizeof(JournalRecordHeader) + static_cast<size_t>(writes.size()) * (sizeof(Bno) + blockSize);
+	pending.resize(start + recordSize);
+	uint8_t *record = pending.data() + start;
+	JournalRecordHeader header{JOURNAL_MAGIC, blockSize, nextSequence, static_cast<uint32_t>(writes.size()), 0, 0};
+	memcpy(record, &header, sizeof(header));
+	uint8_t *numbers = record + sizeof(JournalRecordHeader);
+	uint8_t *data = numbers + static_cast<size_t>(writes.size()) * sizeof(Bno);
+	for (uint32_t slot = 0; slot < writes.size(); slot++)
+	{
+		Bno blockNumber = writes.blockAt(slot);
+		memcpy(numbers + static_cast<size_t>(slot) * sizeof(Bno), &blockNumber, sizeof(Bno));
+		memcpy(data + static_cast<size_t>(slot) * blockSize, writes.dataAt(slot), blockSize);
+		journaledBlocks.insert(blockNumber);
+	}
+	header.checksum = journalChecksum(record, recordSize);
+	memcpy(record + offsetof(JournalRecordHeader, checksum), &header.checksum, sizeof(uint64_t));
+	nextSequence++;
+	return SUCCESS;
+}
+
+size_t Journal::pendingBytes()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return pending.size();
+}
+
+uint64_t Journal::size()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return fileSize + pending.size();
+}
+
+bool Journal::contains(Bno firstBlock, Bno endBlock)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (journaledBlocks.empty())
+	{
+		return false;
+	}
+	for (Bno blockNumber = firstBlock; blockNumber < endBlock; blockNumber++)
+	{
+		if (journaledBlocks.count(blockNumber) != 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void Journal::markInPlaceData()
+{
+	if (fd < 0)
+	{
+		return;
+	}
+	std::lock_guard<std::mutex> lock(mutex);
+	inPlaceDataUnsynced = true;
+}
+
+ErrorCode Journal::flushLocked(BlockBackend &backend)
+{
+	if (pending.empty())
+	{
+		return SUCCESS;
+	}
+	if (inPlaceDataUnsynced)
+	{
+		ErrorCode err = backend.sync(true);
+		if (err != SUCCESS)
+		{
+			return err;
+		}
+		inPlaceDataUnsynced = false;
+	}
+	if (!writeAll(fd, fileSize, pending.data(), pending.size()) || ::fdatasync(fd) < 0)
+	{
+		return ERROR_WRITE_FAIL;
+	}
+	fileSize += pending.size();
+	pending.clear();
+	return SUCCESS;
+}
+
+ErrorCode Journal::flush(BlockBackend &backend)
+{
+	if (fd < 0)
+	{
+		return SUCCESS;
+	}
+	std::lock_guard<std::mutex> lock(mutex);
+	return flushLocked(backend);
+}
+
+ErrorCode Journal::reset()
+{
+	if (fd < 0)
+	{
+		return SUCCESS;
+	}
+	std::lock_guard<std::mutex> lock(mutex);
+	pending.clear();
+	journaledBlocks.clear();
+	if (fileSize == 0)
+	{
+		return SUCCESS;
+	}
+	if (ftruncate(fd, 0) < 0 || ::fdatasync(fd) < 0)
+	{
+		return ERROR_WRITE_FAIL;
+	}
+	fileSize = 0;
+	return SUCCESS;
+}
+
+ErrorCode Journal::close()
+{
+	if (fd < 0)
+	{
+		return SUCCESS;
+	}
+	pending.clear();
+	journaledBlocks.clear();
+	int closingFd = fd;
+	fd = -1;
+	if (::close(closingFd) < 0)
+	{
+		return ERROR_CLOSE_DEVICE_FAIL;
+	}
+	return SUCCESS;
+}
@@ -0,0 +1,160 @@
+#include "PathCache.h"
+#include "Utils.h"
+
+std::string canonicalPath(const std::vector<std::string> &components)
+{
+	std::string path;
+	for (const std::string &component : components)
+	{
+		path += '/';
+		path += component;
+	}
+	return path.empty() ? "/" : path;
+}
+
+void PathCache::setCapacity(uint32_t capacity)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	this->capacity = capacity;
+	evict();
+}
+
+bool PathCache::lookup(const std::string &canonicalPath, bool resolveLastLink, Ino &outInodeNumber)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	auto it = entries.find(canonicalPath);
+	if (it == entries.end() || it->second.inodeNumbers[resolveLastLink] == 0)
+	{
+		return false;
+	}
+	lru.splice(lru.begin(), lru, it->second.lruPosition);
+	outInodeNumber = it->second.inodeNumbers[resolveLastLink];
+	return true;
+}
+
+uint64_t PathCache::getGeneration()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return generation;
+}
+
+void PathCache::insert(const std::string &canonicalPath, bool resolveLastLink, Ino inodeNumber, uint64_t lookupGeneration)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (capacity == 0 || isInTransaction || lookupGeneration != generation)
+	{
+		return;
+	}
+	auto it = entries.find(canonicalPath);
+	if (it != entries.end())
+	{
+		it->second.inodeNumbers[resolveLastLink] = inodeNumber;
+		lru.splice(lru.begin(), lru, it->second.lruPosition);
+		return;
+	}
+	lru.push_front(canonicalPath);
+	PathCacheEntry entry{{0, 0}, lru.begin()};
+	entry.inodeNumbers[resolveLastLink] = inodeNumber;
+	entries.emplace(canonicalPath, entry);
+	orderedPaths.insert(canonicalPath);
+	evict();
+}
+
+void PathCache::invalidate(const std::string &path, bool followedLink)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	generation++;
+	std::vector<std::string> components = splitPath(path);
+	for (const std::string &component : components)
+	{
+		if (component == "." || component == "..")
+		{
+			followedLink = true;
+			break;
+		}
+	}
+	if (followedLink)
+	{
+		entries.clear();
+		orderedPaths.clear();
+		lru.clear();
+		return;
+	}
+	std::string prefix = canonicalPath(components);
+	erase(prefix);
+	if (prefix != "/")
+	{
+		prefix += '/';
+	}
+	auto it = orderedPaths.lower_bound(prefix);
+	while (it != orderedPaths.end() && it->compare(0, prefix.size(), prefix) == 0)
+	{
+		auto entryIt = entries.find(*it);
+		lru.erase(entryIt->second.lruPosition);
+		entries.erase(entryIt);
+		it = orderedPaths.erase(it);
+	}
+}
+
+void PathCache::erase(const std::string &canonicalPath)
+{
+	auto it = entries.find(canonicalPath);
+	if (it == entries.end())
+	{
+		return;
+	}
+	lru.erase(it->second.lruPosition);
+	entries.erase(it);
+	orderedPaths.erase(canonicalPath);
+}
+
+void PathCache::evict()
+{
+	while (entries.size() > capacity && !lru.empty())
+	{
+		std::string victim = lru.back();
+		erase(victim);
+	}
+}
+
+ErrorCode PathCache::beginTransaction()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (isInTransaction)
+	{
+		return ERROR_IS_IN_TRANSACTION;
+	}
+	isInTransaction = true;
+	return SUCCESS;
+}
+
+ErrorCode PathCache::revertTransaction()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (!isInTransaction)
+	{
+		return ERROR_FS_BROKEN;
+	}
+	isInTransaction = false;
+	return SUCCESS;
+}
+
+ErrorCode PathCache::commitTransaction()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (!isInTransaction)
+	{
+		return ERROR_FS_BROKEN;
+	}
+	isInTransaction = false;
+	return SUCCESS;
+}
+
+void PathCache::clear()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	entries.clear();
+	orderedPaths.clear();
+	lru.clear();
+	generation++;
+}
@@ -2,6 +2,10 @@
 #include "Utils.h"
 #include "Constants.h"
 
+thread_local uint32_t PathResolver::resolvePathDepth = 0;
+thread_local bool PathResolver::resolvePathInProgress = false;
+thread_local bool PathResolver::resolvePathFollowedLink = false;
+
 void PathResolver::setInodeReader(InodeReader &inodeReader)
 {
 	this->inodeReader = &inodeReader;
@@ -17,7 +21,22 @@ void PathResolver::setLinkReader(LinkReader &linkReader)
 	this->linkReader = &linkReader;
 }
 
-Ino PathResolver::getInodeFromParentAndName(Ino parentInodeNumber, const std::string &name, ErrorCode &outError)
+void PathResolver::setDentryCache(DentryCache &dentryCache)
+{
+	this->dentryCache = &dentryCache;
+}
+
+void PathResolver::setPathCache(PathCache &pathCache)
+{
+	this->pathCache = &pathCache;
+}
+
+void PathResolver::setDirIndex(DirIndex &dirIndex)
+{
+	this->dirIndex = &dirIndex;
+}
+
+Ino PathResolver::lookupEntry(Ino parentInodeNumber, const std::string &name, uint32_t &outEntryIndex, ErrorCode &outError)
 {
 	MinixInode3 parentInode;
 	ErrorCode err = inodeReader->readInode(parentInodeNumber, &parentInode);
@@ -31,101 +50,78 @@ Ino PathResolver::getInodeFromParentAndName(Ino parentInodeNumber, const std::st
 		outError = ERROR_NOT_DIRECTORY;
 		return 0;
 	}
-	uint32_t dirSize = parentInode.i_size;
-	uint8_t *dirData = static_cast<uint8_t*>(malloc(dirSize));
-	if (dirData == nullptr)
+	Ino cachedInodeNumber;
+	if (dentryCache->lookup(parentInodeNumber, name, cachedInodeNumber, outEntryIndex))
 	{
-		outError = ERROR_CANNOT_ALLOCATE_MEMORY;
-		return 0;
+		outError = cachedInodeNumber == 0 ? ERROR_FILE_NOT_FOUND : SUCCESS;
+		return cachedInodeNumber;
 	}
-	err = dirReader->readDirRaw(parentInodeNumber, dirData, dirSize, 0);
-	if (err != SUCCESS)
+	DirIndexEntry entry;
+	err = dirIndex->find(parentInodeNumber, name, entry);
+	if (err == ERROR_FILE_NOT_FOUND)
 	{
-		outError = err;
-		free(dirData);
-		return 0;
+		dentryCache->insert(parentInodeNumber, name, 0, 0);
 	}
-	if (dirSize % sizeof(DirEntryOnDisk) != 0)
+	if (err != SUCCESS)
 	{
-		free(dirData);
-		outError = ERROR_FS_BROKEN;
+		outError = err;
 		return 0;
 	}
-	for (uint32_t offset = 0; offset < dirSize; offset += sizeof(DirEntryOnDisk))
-	{
-		DirEntryOnDisk *entry = reinterpret_cast<DirEntryOnDisk*>(dirData + offset);
-		std::string entryName = char60ToString(entry->d_name);
-		if (entryName == name && entry->d_inode != 0)
-		{
-			Ino inodeNumber = entry->d_inode;
-			free(dirData);
-			outError = SUCCESS;
-			return inodeNumber;
-		}
-	}
-	free(dirData);
-	outError = ERROR_FILE_NOT_FOUND;
-	return 0;
+	dentryCache->insert(parentInodeNumber, name, entry.inodeNumber, entry.slot);
+	outEntryIndex = entry.slot;
+	outError = SUCCESS;
+	return entry.inodeNumber;
+}
+
+Ino PathResolver::getInodeFromParentAndName(Ino parentInodeNumber, const std::string &name, ErrorCode &outError)
+{
+	uint32_t entryIndex;
+	return lookupEntry(parentInodeNumber, name, entryIndex, outError);
 }
 
 uint32_t PathResolver::getIdxFromParentAndName(Ino parentInodeNumber, const std::string &name, ErrorCode &outError)
 {
-	MinixInode3 parentInode;
-	ErrorCode err = inodeReader->readInode(parentInodeNumber, &parentInode);
-	if (err != SUCCESS)
-	{
-		outError = err;
-		return 0;
-	}
-	if (!parentInode.isDirectory())
-	{
-		outError = ERROR_NOT_DIRECTORY;
-		return 0;
-	}
-	uint32_t dirSize = parentInode.i_size;
-	uint8_t *dirData = static_cast<uint8_t*>(malloc(dirSize));
-	if (dirData == nullptr)
-	{
-		outError = ERROR_CANNOT_ALLOCATE_MEMORY;
-		return 0;
-	}
-	err = dirReader->readDirRaw(parentInodeNumber, dirData, dirSize, 0);
-	if (err != SUCCESS)
-	{
-		outError = err;
-		free(dirData);
-		return 0;
-	}
-	if (dirSize % sizeof(DirEntryOnDisk) != 0)
+	uint32_t entryIndex = 0;
+	lookupEntry(parentInodeNumber, name, entryIndex, outError);
+	if (outError != SUCCESS)
 	{
-		free(dirData);
-		outError = ERROR_FS_BROKEN;
 		return 0;
 	}
-	for (uint32_t offset = 0; offset < dirSize; offset += sizeof(DirEntryOnDisk))
-	{
-		DirEntryOnDisk *entry = reinterpret_cast<DirEntryOnDisk*>(dirData + offset);
-		std::string entryName = char60ToString(entry->d_name);
-		if (entryName == name && entry->d_inode != 0)
-		{
-			uint32_t idx = offset / sizeof(DirEntryOnDisk);
-			free(dirData);
-			outError = SUCCESS;
-			return idx;
-		}
-	}
-	free(dirData);
-	outError = ERROR_FILE_NOT_FOUND;
-	return 0;
+	return entryIndex;
 }
 
 Ino PathResolver::resolvePath(const std::string &path, ErrorCode &outError, Ino currentInode, bool resolveLastLink)
 {
 	std::vector<std::string> components = splitPath(path);
 	bool isResolveStart = false;
+	bool isCacheable = false;
+	std::string cacheKey;
+	uint64_t cacheGeneration = 0;
 	if (!resolvePathInProgress)
 	{
+		isCacheable = currentInode == MINIX3_ROOT_INODE && !components.empty();
+		for (const std::string &component : components)
+		{
+			if (component == "." || component == "..")
+			{
+				isCacheable = false;
+				break;
+			}
+		}
+		if (isCacheable)
+		{
+			cacheKey = canonicalPath(components);
+			Ino cachedInodeNumber;
+			if (pathCache->lookup(cacheKey, resolveLastLink, cachedInodeNumber))
+			{
+				resolvePathFollowedLink = false;
+				outError = SUCCESS;
+				return cachedInodeNumber;
+			}
+			cacheGeneration = pathCache->getGeneration();
+		}
 		resolvePathDepth = 0;
+		resolvePathFollowedLink = false;
 		resolvePathInProgress = true;
 		isResolveStart = true;
 	}
@@ -178,6 +174,7 @@ Ino PathResolver::resolvePath(const std::string &path, ErrorCode &outError, Ino
 		}
 		if (inode.isSymbolicLink())
 		{
+			resolvePathFollowedLink = true;
 			std::string linkTarget;
 			err = linkReader->readLink(currentInode, linkTarget);
 			if (err != SUCCESS)
@@ -215,6 +212,10 @@ Ino PathResolver::resolvePath(const std::string &path, ErrorCode &outError, Ino
 	if (isResolveStart)
 	{
 		resolvePathInProgress = false;
+		if (isCacheable && !resolvePathFollowedLink)
+		{
+			pathCache->insert(cacheKey, resolveLastLink, currentInode, cacheGeneration);
+		}
 	}
 	return currentInode;
 }
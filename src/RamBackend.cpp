@@ -0,0 +1,133 @@
+#include "RamBackend.h"
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+RamBackend::RamBackend(const std::string &path): imagePath(path) {}
+
+RamBackend::RamBackend(std::vector<uint8_t> data): imagePath(""), image(std::move(data)) {}
+
+const std::vector<uint8_t> &RamBackend::getImage() const
+{
+	return image;
+}
+
+ErrorCode RamBackend::save(const std::string &path) const
+{
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file)
+	{
+		return ERROR_OPEN_DEVICE_FAIL;
+	}
+	file.write(reinterpret_cast<const char*>(image.data()), image.size());
+	if (!file)
+	{
+		return ERROR_WRITE_FAIL;
+	}
+	return SUCCESS;
+}
+
+ErrorCode RamBackend::open()
+{
+	if (!imagePath.empty())
+	{
+		std::ifstream file(imagePath, std::ios::binary);
+		if (!file)
+		{
+			return ERROR_OPEN_DEVICE_FAIL;
+		}
+		image.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+		imagePath.clear();
+	}
+	if (image.empty())
+	{
+		return ERROR_OPEN_DEVICE_FAIL;
+	}
+	return SUCCESS;
+}
+
+ErrorCode RamBackend::close()
+{
+	return SUCCESS;
+}
+
+ErrorCode RamBackend::read(uint64_t offset, void* buffer, size_t size)
+{
+	if (offset + size > image.size())
+	{
+		return ERROR_READ_FAIL;
+	}
+	memcpy(buffer, image.data() + offset, size);
+	return SUCCESS;
+}
+
+ErrorCode RamBackend::write(uint64_t offset, const void* buffer, size_t size)
+{
+	if (offset + size > image.size())
+	{
+		return ERROR_WRITE_FAIL;
+	}
+	memcpy(image.data() + offset, buffer, size);
+	return SUCCESS;
+}
+
+ErrorCode RamBackend::readVector(uint64_t offset, const iovec *vectors, size_t count, size_t size)
+{
+	if (offset + size > image.size())
+	{
+		return ERROR_READ_FAIL;
+	}
+	for (size_t i = 0; i < count; i++)
+	{
+		memcpy(vectors[i].iov_base, image.data() + offset, vectors[i].iov_len);
+		offset += vectors[i].iov_len;
+	}
+	return SUCCESS;
+}
+
+ErrorCode RamBackend::writeVector(uint64_t offset, const iovec *vectors, size_t count, size_t size)
+{
+	if (offset + size > image.size())
+	{
+		return ERROR_WRITE_FAIL;
+	}
+	for (size_t i = 0; i < count; i++)
+	{
+		memcpy(image.data() + offset, vectors[i].iov_base, vectors[i].iov_len);
+		offset += vectors[i].iov_len;
+	}
+	return SUCCESS;
+}
+
+ErrorCode RamBackend::readBatch(std::vector<IoUringRequest> &requests)
+{
+	for (IoUringRequest &request : requests)
+	{
+		ErrorCode err = readVector(request.offset, request.vectors, request.vectorCount, request.size);
+		if (err != SUCCESS)
+		{
+			return err;
+		}
+		request.result = static_cast<int32_t>(request.size);
+	}
+	return SUCCESS;
+}
+
+uint8_t *RamBackend::memory(uint64_t offset, size_t size)
+{
+	if (offset + size > image.size())
+	{
+		return nullptr;
+	}
+	return image.data() + offset;
+}
+
+bool RamBackend::isMemoryBacked() const
+{
+	return true;
+}
+
+ErrorCode RamBackend::sync(bool)
+{
+	return SUCCESS;
+}
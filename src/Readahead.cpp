@@ -0,0 +1,135 @@
+#include "Readahead.h"
+#include "Constants.h"
+#include <algorithm>
+
+void Readahead::setLayout(Layout &layout)
+{
+	this->layout = &layout;
+}
+
+void Readahead::setInodeReader(InodeReader &inodeReader)
+{
+	this->inodeReader = &inodeReader;
+}
+
+void Readahead::setFileReader(FileReader &fileReader)
+{
+	this->fileReader = &fileReader;
+}
+
+void Readahead::setTransactionManager(TransactionManager &transactionManager)
+{
+	this->transactionManager = &transactionManager;
+}
+
+void Readahead::setMaxWindowZones(uint32_t zones)
+{
+	maxWindowZones = zones;
+}
+
+void Readahead::onRead(ReadaheadState &state, Ino inodeNumber, uint32_t offset, uint32_t size)
+{
+	if (maxWindowZones == 0 || size == 0)
+	{
+		return;
+	}
+	uint64_t end = static_cast<uint64_t>(offset) + size;
+	ReadaheadRequest request;
+	{
+		std::lock_guard<std::mutex> lock(state.mutex);
+		if (offset != state.nextOffset)
+		{
+			state.windowZones = 0;
+			state.prefetchedEnd = 0;
+			state.nextOffset = end;
+			return;
+		}
+		state.nextOffset = end;
+		if (state.prefetchedEnd > end && state.prefetchedEnd - end > static_cast<uint64_t>(state.windowZones) * layout->zoneSize / 2)
+		{
+			return;
+		}
+		state.windowZones = state.windowZones == 0 ? std::min<uint32_t>(READAHEAD_MIN_ZONES, maxWindowZones) : std::min(state.windowZones * 2, maxWindowZones);
+		uint64_t start = std::max(state.prefetchedEnd, end);
+		start -= start % layout->zoneSize;
+		uint64_t stop = std::min<uint64_t>(start + static_cast<uint64_t>(state.windowZones) * layout->zoneSize, MINIX3_MAX_FILE_SIZE);
+		if (start >= stop)
+		{
+			return;
+		}
+		state.prefetchedEnd = stop;
+		request = ReadaheadRequest{inodeNumber, static_cast<uint32_t>(start), static_cast<uint32_t>(stop - start)};
+	}
+	schedule(request);
+}
+
+void Readahead::schedule(const ReadaheadRequest &request)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (stopping)
+	{
+		return;
+	}
+	if (!worker.joinable())
+	{
+		worker = std::thread(&Readahead::run, this);
+	}
+	if (queue.size() >= READAHEAD_QUEUE_LIMIT)
+	{
+		queue.pop_front();
+	}
+	queue.push_back(request);
+	wakeup.notify_one();
+}
+
+void Readahead::run()
+{
+	while (true)
+	{
+		ReadaheadRequest request;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wakeup.wait(lock, [this] { return stopping || !queue.empty(); });
+			if (stopping)
+			{
+				return;
+			}
+			request = queue.front();
+			queue.pop_front();
+		}
+		prefetch(request);
+	}
+}
+
+void Readahead::prefetch(const ReadaheadRequest &request)
+{
+	auto lock = transactionManager->lockForRead();
+	MinixInode3 inode;
+	if (inodeReader->readInode(request.inodeNumber, &inode) != SUCCESS)
+	{
+		return;
+	}
+	if (!inode.isRegularFile() || request.offset >= inode.i_size)
+	{
+		return;
+	}
+	uint32_t size = std::min(request.size, inode.i_size - request.offset);
+	buffer.resize(size);
+	fileReader->readFile(inode, buffer.data(), size, request.offset);
+}
+
+void Readahead::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+		queue.clear();
+	}
+	wakeup.notify_all();
+	if (worker.joinable())
+	{
+		worker.join();
+	}
+	std::lock_guard<std::mutex> lock(mutex);
+	stopping = false;
+}
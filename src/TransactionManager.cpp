@@ -15,11 +15,41 @@ void TransactionManager::setZmapAllocator(Allocator &zmapAllocator)
 	this->zmapAllocator = &zmapAllocator;
 }
 
+void TransactionManager::setInodeCache(InodeCache &inodeCache)
+{
+	this->inodeCache = &inodeCache;
+}
+
+void TransactionManager::setDentryCache(DentryCache &dentryCache)
+{
+	this->dentryCache = &dentryCache;
+}
+
+void TransactionManager::setPathCache(PathCache &pathCache)
+{
+	this->pathCache = &pathCache;
+}
+
+void TransactionManager::setDirIndex(DirIndex &dirIndex)
+{
+	this->dirIndex = &dirIndex;
+}
+
 bool TransactionManager::isWriteLocked() const
 {
 	return writeLocked;
 }
 
+std::unique_lock<std::mutex> TransactionManager::lockForWrite()
+{
+	return std::unique_lock<std::mutex>(writerMutex);
+}
+
+std::shared_lock<std::shared_mutex> TransactionManager::lockForRead()
+{
+	return std::shared_lock<std::shared_mutex>(commitMutex);
+}
+
 ErrorCode TransactionManager::beginTransaction()
 {
 	if (writeLocked)
@@ -49,6 +79,44 @@ ErrorCode TransactionManager::beginTransaction()
 		imapAllocator->revertTransaction();
 		return err;
 	}
+	err = inodeCache->beginTransaction();
+	if (err != SUCCESS)
+	{
+		blockDevice->revertTransaction();
+		imapAllocator->revertTransaction();
+		zmapAllocator->revertTransaction();
+		return err;
+	}
+	err = dentryCache->beginTransaction();
+	if (err != SUCCESS)
+	{
+		blockDevice->revertTransaction();
+		imapAllocator->revertTransaction();
+		zmapAllocator->revertTransaction();
+		inodeCache->revertTransaction();
+		return err;
+	}
+	err = pathCache->beginTransaction();
+	if (err != SUCCESS)
+	{
+		blockDevice->revertTransaction();
+		imapAllocator->revertTransaction();
+		zmapAllocator->revertTransaction();
+		inodeCache->revertTransaction();
+		dentryCache->revertTransaction();
+		return err;
+	}
+	err = dirIndex->beginTransaction();
+	if (err != SUCCESS)
+	{
+		blockDevice->revertTransaction();
+		imapAllocator->revertTransaction();
+		zmapAllocator->revertTransaction();
+		inodeCache->revertTransaction();
+		dentryCache->revertTransaction();
+		pathCache->revertTransaction();
+		return err;
+	}
 	isInTransaction = true;
 	return SUCCESS;
 }
@@ -75,6 +143,26 @@ ErrorCode TransactionManager::revertTransaction()
 	{
 		return err;
 	}
+	err = inodeCache->revertTransaction();
+	if (err != SUCCESS)
+	{
+		return err;
+	}
+	err = dentryCache->revertTransaction();
+	if (err != SUCCESS)
+	{
+		return err;
+	}
+	err = pathCache->revertTransaction();
+	if (err != SUCCESS)
+	{
+		return err;
+	}
+	err = dirIndex->revertTransaction();
+	if (err != SUCCESS)
+	{
+		return err;
+	}
 	isInTransaction = false;
 	return SUCCESS;
 }
@@ -85,7 +173,13 @@ ErrorCode TransactionManager::commitTransaction()
 	{
 		return ERROR_IS_NOT_IN_TRANSACTION;
 	}
+	std::unique_lock<std::shared_mutex> publishLock(commitMutex);
 	ErrorCode err;
+	err = inodeCache->commitTransaction();
+	if (err != SUCCESS)
+	{
+		return setWriteLock(err);
+	}
 	err = imapAllocator->commitTransaction();
 	if (err != SUCCESS)
 	{
@@ -111,6 +205,21 @@ ErrorCode TransactionManager::commitTransaction()
 	{
 		return setWriteLock(err);
 	}
+	err = dentryCache->commitTransaction();
+	if (err != SUCCESS)
+	{
+		return setWriteLock(err);
+	}
+	err = pathCache->commitTransaction();
+	if (err != SUCCESS)
+	{
+		return setWriteLock(err);
+	}
+	err = dirIndex->commitTransaction();
+	if (err != SUCCESS)
+	{
+		return setWriteLock(err);
+	}
 	isInTransaction = false;
 	return SUCCESS;
 }
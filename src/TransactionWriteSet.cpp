@@ -0,0 +1,136 @@
+#include "TransactionWriteSet.h"
+#include "Constants.h"
+#include <algorithm>
+#include <cstdlib>
+
+TransactionWriteSet::TransactionWriteSet(): blockSize(0) {}
+
+TransactionWriteSet::~TransactionWriteSet()
+{
+	release();
+}
+
+void TransactionWriteSet::setBlockSize(uint32_t size)
+{
+	if (size != blockSize)
+	{
+		release();
+		blockSize = size;
+	}
+}
+
+void TransactionWriteSet::release()
+{
+	for (uint8_t *chunk : chunks)
+	{
+		free(chunk);
+	}
+	chunks.clear();
+	blocks.clear();
+	index.clear();
+	order.clear();
+}
+
+size_t TransactionWriteSet::size() const
+{
+	return blocks.size();
+}
+
+uint32_t TransactionWriteSet::position(Bno blockNumber) const
+{
+	uint32_t mask = static_cast<uint32_t>(index.size() - 1);
+	uint32_t pos = (blockNumber * 2654435761u) & mask;
+	while (index[pos] != 0 && blocks[index[pos] - 1] != blockNumber)
+	{
+		pos = (pos + 1) & mask;
+	}
+	return pos;
+}
+
+void TransactionWriteSet::grow()
+{
+	index.assign(std::max<size_t>(TRANSACTION_INDEX_MIN_ENTRIES, index.size() * 2), 0);
+	for (uint32_t slot = 0; slot < blocks.size(); slot++)
+	{
+		index[position(blocks[slot])] = slot + 1;
+	}
+}
+
+uint8_t *TransactionWriteSet::find(Bno blockNumber) const
+{
+	if (blocks.empty())
+	{
+		return nullptr;
+	}
+	uint32_t entry = index[position(blockNumber)];
+	return entry == 0 ? nullptr : dataAt(entry - 1);
+}
+
+uint8_t *TransactionWriteSet::insert(Bno blockNumber)
+{
+	if ((blocks.size() + 1) * 2 > index.size())
+	{
+		grow();
+	}
+	uint32_t pos = position(blockNumber);
+	if (index[pos] != 0)
+	{
+		return dataAt(index[pos] - 1);
+	}
+	uint32_t slot = static_cast<uint32_t>(blocks.size());
+	if (slot / TRANSACTION_ARENA_CHUNK_BLOCKS == chunks.size())
+	{
+		void *memory = nullptr;
+		if (posix_memalign(&memory, BLOCK_CACHE_ALIGNMENT, static_cast<size_t>(TRANSACTION_ARENA_CHUNK_BLOCKS) * blockSize) != 0)
+		{
+			return nullptr;
+		}
+		chunks.push_back(static_cast<uint8_t*>(memory));
+	}
+	blocks.push_back(blockNumber);
+	index[pos] = slot + 1;
+	return dataAt(slot);
+}
+
+void TransactionWriteSet::clear()
+{
+	if (blocks.size() * 4 >= index.size())
+	{
+		std::fill(index.begin(), index.end(), 0);
+	}
+	else
+	{
+		for (size_t slot = blocks.size(); slot > 0; slot--)
+		{
+			index[position(blocks[slot - 1])] = 0;
+		}
+	}
+	blocks.clear();
+	order.clear();
+	while (chunks.size() > TRANSACTION_ARENA_RETAINED_CHUNKS)
+	{
+		free(chunks.back());
+		chunks.pop_back();
+	}
+}
+
+const std::vector<uint32_t> &TransactionWriteSet::sortedSlots()
+{
+	order.resize(blocks.size());
+	for (uint32_t slot = 0; slot < blocks.size(); slot++)
+	{
+		order[slot] = slot;
+	}
+	std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) { return blocks[a] < blocks[b]; });
+	return order;
+}
+
+Bno TransactionWriteSet::blockAt(uint32_t slot) const
+{
+	return blocks[slot];
+}
+
+uint8_t *TransactionWriteSet::dataAt(uint32_t slot) const
+{
+	return chunks[slot / TRANSACTION_ARENA_CHUNK_BLOCKS] + static_cast<size_t>(slot % TRANSACTION_ARENA_CHUNK_BLOCKS) * blockSize;
+}
@@ -0,0 +1,206 @@
+#!/usr/bin/env bash
+set -euo pipefail
+export LC_ALL=C
+export LANG=C
+
+if [[ $# -ne 3 ]]; then
+    echo "Usage: $0 <minixfs-fuse-bin> <fixture-dir> <work-dir>" >&2
+    exit 2
+fi
+
+FUSE_BIN="$1"
+FIXTURE_DIR="$2"
+WORK_DIR="$3"
+
+require_cmd() {
+    if ! command -v "$1" >/dev/null 2>&1; then
+        echo "SKIP: missing command '$1'" >&2
+        exit 77
+    fi
+}
+
+require_cmd mountpoint
+require_cmd fusermount3
+require_cmd fsck.minix
+require_cmd stat
+require_cmd cmp
+require_cmd head
+require_cmd yes
+require_cmd grep
+require_cmd ls
+
+if [[ ! -x "${FUSE_BIN}" ]]; then
+    echo "FAIL: fuse binary not executable: ${FUSE_BIN}" >&2
+    exit 1
+fi
+
+if [[ ! -r "${FIXTURE_DIR}/disk.img" ]]; then
+    echo "SKIP: fixture not found, run tests/generate_minixfs_write_fixture.sh first" >&2
+    exit 77
+fi
+
+IMG_SRC="${FIXTURE_DIR}/disk.img"
+IMG_RUN="${WORK_DIR}/disk.img"
+FUSE_MNT="${WORK_DIR}/fuse_mnt"
+FUSE_LOG="${WORK_DIR}/fuse.log"
+SRC_DIR="${WORK_DIR}/src"
+FAIL_LOG="${WORK_DIR}/failures.log"
+WRITER_DONE="${WORK_DIR}/writer.done"
+READERS=4
+STABLE_FILES=8
+ROUNDS=200
+
+FUSE_PID=""
+cleanup() {
+    set +e
+    if [[ -d "${FUSE_MNT}" ]]; then
+        fusermount3 -u -z "${FUSE_MNT}" >/dev/null 2>&1 || true
+    fi
+    if [[ -n "${FUSE_PID}" ]]; then
+        kill "${FUSE_PID}" >/dev/null 2>&1 || true
+        wait "${FUSE_PID}" >/dev/null 2>&1 || true
+    fi
+}
+trap cleanup EXIT
+
+mount_fuse() {
+    "${FUSE_BIN}" -f --device="${IMG_RUN}" "${FUSE_MNT}" >"${FUSE_LOG}" 2>&1 &
+    FUSE_PID=$!
+    for _ in $(seq 1 50); do
+        if mountpoint -q "${FUSE_MNT}"; then
+            return 0
+        fi
+        sleep 0.1
+    done
+    echo "FAIL: fuse mount did not come up; log:" >&2
+    sed -n '1,120p' "${FUSE_LOG}" >&2 || true
+    exit 1
+}
+
+unmount_fuse() {
+    fusermount3 -u "${FUSE_MNT}"
+    wait "${FUSE_PID}" >/dev/null 2>&1 || true
+    FUSE_PID=""
+}
+
+payload() {
+    head -c $((3000 + $1 * 97)) < <(yes "payload-$1")
+}
+
+writer() {
+    local i
+    mkdir "${FUSE_MNT}/churn"
+    for i in $(seq 1 "${ROUNDS}"); do
+        payload "${i}" > "${FUSE_MNT}/churn/tmp_${i}"
+        mv "${FUSE_MNT}/churn/tmp_${i}" "${FUSE_MNT}/churn/file_${i}"
+        if (( i > 1 )); then
+            rm "${FUSE_MNT}/churn/file_$((i - 1))"
+        fi
+        if (( i % 20 == 0 )); then
+            mkdir "${FUSE_MNT}/churn/dir_${i}"
+            mv "${FUSE_MNT}/churn/dir_${i}" "${FUSE_MNT}/dir_${i}"
+            rmdir "${FUSE_MNT}/dir_${i}"
+        fi
+    done
+}
+
+reader() {
+    local id="$1"
+    local path name result
+    while [[ ! -e "${WRITER_DONE}" ]]; do
+        for name in $(seq 1 "${STABLE_FILES}"); do
+            if ! cmp -s "${SRC_DIR}/stable_${name}" "${FUSE_MNT}/stable_${name}"; then
+                echo "reader ${id}: stable_${name} content mismatch" >> "${FAIL_LOG}"
+            fi
+            stat "${FUSE_MNT}/stable_${name}" >/dev/null || echo "reader ${id}: stat stable_${name} failed" >> "${FAIL_LOG}"
+        done
+        for path in "${FUSE_MNT}"/churn/file_*; do
+            [[ -e "${path}" ]] || continue
+            name="${path##*/file_}"
+            result=0
+            cmp -s <(payload "${name}") "${path}" 2>/dev/null || result=$?
+            if [[ "${result}" == "1" ]]; then
+                echo "reader ${id}: ${path##*/} content mismatch" >> "${FAIL_LOG}"
+            fi
+        done
+    done
+}
+
+if [[ -d "${FUSE_MNT}" ]]; then
+    fusermount3 -u -z "${FUSE_MNT}" >/dev/null 2>&1 || true
+fi
+rm -rf "${WORK_DIR}"
+mkdir -p "${FUSE_MNT}" "${SRC_DIR}"
+: > "${FAIL_LOG}"
+cp "${IMG_SRC}" "${IMG_RUN}"
+for name in $(seq 1 "${STABLE_FILES}"); do
+    head -c $((name * 12289)) /dev/urandom > "${SRC_DIR}/stable_${name}"
+done
+
+mount_fuse
+for name in $(seq 1 "${STABLE_FILES}"); do
+    cp "${SRC_DIR}/stable_${name}" "${FUSE_MNT}/stable_${name}"
+done
+
+READER_PIDS=()
+for id in $(seq 1 "${READERS}"); do
+    reader "${id}" &
+    READER_PIDS+=($!)
+done
+writer &
+WRITER_PID=$!
+writer_result=0
+wait "${WRITER_PID}" || writer_result=$?
+touch "${WRITER_DONE}"
+for pid in "${READER_PIDS[@]}"; do
+    wait "${pid}"
+done
+
+if [[ "${writer_result}" != "0" ]]; then
+    echo "FAIL: writer operations failed while readers were running" >&2
+    exit 1
+fi
+if [[ -s "${FAIL_LOG}" ]]; then
+    echo "FAIL: readers observed inconsistent state:" >&2
+    sed -n '1,40p' "${FAIL_LOG}" >&2
+    exit 1
+fi
+
+check_final_state() {
+    local name entries
+    for name in $(seq 1 "${STABLE_FILES}"); do
+        if ! cmp -s "${SRC_DIR}/stable_${name}" "${FUSE_MNT}/stable_${name}"; then
+            echo "FAIL: stable_${name} content mismatch $1" >&2
+            exit 1
+        fi
+    done
+    if ! cmp -s <(payload "${ROUNDS}") "${FUSE_MNT}/churn/file_${ROUNDS}"; then
+        echo "FAIL: last renamed file content mismatch $1" >&2
+        exit 1
+    fi
+    entries="$(ls -A "${FUSE_MNT}/churn")"
+    if [[ "${entries}" != "file_${ROUNDS}" ]]; then
+        echo "FAIL: unexpected churn entries $1: ${entries}" >&2
+        exit 1
+    fi
+    if ls -d "${FUSE_MNT}"/dir_* >/dev/null 2>&1; then
+        echo "FAIL: renamed directories should be removed $1" >&2
+        exit 1
+    fi
+}
+
+check_final_state "after concurrent run"
+unmount_fuse
+
+fsck.minix -f "${IMG_RUN}" >"${WORK_DIR}/fsck.log" 2>&1 || true
+if grep -v -e 'Forcing filesystem check' -e 'marked in use, no file uses it' "${WORK_DIR}/fsck.log" | grep -q .; then
+    echo "FAIL: fsck.minix reported errors after concurrent run:" >&2
+    sed -n '1,40p' "${WORK_DIR}/fsck.log" >&2 || true
+    exit 1
+fi
+
+mount_fuse
+check_final_state "after remount"
+unmount_fuse
+
+echo "PASS: concurrent readers and writer keep the filesystem consistent"
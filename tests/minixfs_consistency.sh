@@ -3,14 +3,16 @@ set -euo pipefail
 export LC_ALL=C
 export LANG=C
 
-if [[ $# -ne 3 ]]; then
-    echo "Usage: $0 <minixfs-fuse-bin> <fixture-dir> <work-dir>" >&2
+if [[ $# -lt 3 ]]; then
+    echo "Usage: $0 <minixfs-fuse-bin> <fixture-dir> <work-dir> [mount-option...]" >&2
     exit 2
 fi
 
 FUSE_BIN="$1"
 FIXTURE_DIR="$2"
 WORK_DIR="$3"
+shift 3
+MOUNT_OPTIONS=("$@")
 
 require_cmd() {
     if ! command -v "$1" >/dev/null 2>&1; then
@@ -63,7 +65,7 @@ trap cleanup EXIT
 rm -rf "${WORK_DIR}"
 mkdir -p "${FUSE_MNT}"
 
-"${FUSE_BIN}" -f --device="${IMG}" "${FUSE_MNT}" >"${FUSE_LOG}" 2>&1 &
+"${FUSE_BIN}" -f --device="${IMG}" "${MOUNT_OPTIONS[@]}" "${FUSE_MNT}" >"${FUSE_LOG}" 2>&1 &
 FUSE_PID=$!
 
 for _ in $(seq 1 50); do
@@ -0,0 +1,125 @@
+#!/usr/bin/env bash
+set -euo pipefail
+export LC_ALL=C
+export LANG=C
+
+if [[ $# -ne 3 ]]; then
+    echo "Usage: $0 <minixfs-fuse-bin> <fixture-dir> <work-dir>" >&2
+    exit 2
+fi
+
+FUSE_BIN="$1"
+FIXTURE_DIR="$2"
+WORK_DIR="$3"
+
+require_cmd() {
+    if ! command -v "$1" >/dev/null 2>&1; then
+        echo "SKIP: missing command '$1'" >&2
+        exit 77
+    fi
+}
+
+require_cmd mountpoint
+require_cmd fusermount3
+require_cmd strace
+require_cmd awk
+require_cmd dd
+require_cmd cmp
+require_cmd head
+require_cmd sync
+require_cmd readlink
+
+if [[ ! -x "${FUSE_BIN}" ]]; then
+    echo "FAIL: fuse binary not executable: ${FUSE_BIN}" >&2
+    exit 1
+fi
+
+if [[ ! -r "${FIXTURE_DIR}/disk.img" ]]; then
+    echo "SKIP: fixture not found, run tests/generate_minixfs_write_fixture.sh first" >&2
+    exit 77
+fi
+
+if ! strace -o /dev/null true >/dev/null 2>&1; then
+    echo "SKIP: strace cannot trace processes here" >&2
+    exit 77
+fi
+
+IMG_SRC="${FIXTURE_DIR}/disk.img"
+IMG_RUN="${WORK_DIR}/disk.img"
+JOURNAL_RUN="${WORK_DIR}/disk.journal"
+FUSE_MNT="${WORK_DIR}/fuse_mnt"
+FUSE_LOG="${WORK_DIR}/fuse.log"
+TRACE_LOG="${WORK_DIR}/sync.trace"
+SRC_FILE="${WORK_DIR}/data.bin"
+CHUNK=131072
+
+FUSE_PID=""
+cleanup() {
+    set +e
+    if [[ -d "${FUSE_MNT}" ]]; then
+        fusermount3 -u -z "${FUSE_MNT}" >/dev/null 2>&1 || true
+    fi
+    if [[ -n "${FUSE_PID}" ]]; then
+        kill "${FUSE_PID}" >/dev/null 2>&1 || true
+        wait "${FUSE_PID}" >/dev/null 2>&1 || true
+    fi
+}
+trap cleanup EXIT
+
+if [[ -d "${FUSE_MNT}" ]]; then
+    fusermount3 -u -z "${FUSE_MNT}" >/dev/null 2>&1 || true
+fi
+rm -rf "${WORK_DIR}"
+mkdir -p "${FUSE_MNT}"
+head -c $((8 * CHUNK)) /dev/urandom > "${SRC_FILE}"
+cp "${IMG_SRC}" "${IMG_RUN}"
+IMG_TRACED="$(readlink -f "${IMG_RUN}")"
+JOURNAL_TRACED="$(readlink -f "${JOURNAL_RUN}")"
+
+strace -f -y -qq -e trace=pwritev,pwritev2,fdatasync,fsync -o "${TRACE_LOG}" \
+    "${FUSE_BIN}" -f --device="${IMG_RUN}" --journal="${JOURNAL_RUN}" --ordered-data "${FUSE_MNT}" >"${FUSE_LOG}" 2>&1 &
+FUSE_PID=$!
+for _ in $(seq 1 100); do
+    if mountpoint -q "${FUSE_MNT}"; then
+        break
+    fi
+    sleep 0.1
+done
+if ! mountpoint -q "${FUSE_MNT}"; then
+    echo "FAIL: fuse mount did not come up; log:" >&2
+    sed -n '1,120p' "${FUSE_LOG}" >&2 || true
+    exit 1
+fi
+
+for name in first second; do
+    dd if="${SRC_FILE}" of="${FUSE_MNT}/${name}.bin" bs="${CHUNK}" status=none
+    sync "${FUSE_MNT}/${name}.bin"
+done
+for name in first second; do
+    if ! cmp -s "${SRC_FILE}" "${FUSE_MNT}/${name}.bin"; then
+        echo "FAIL: ${name}.bin content mismatch" >&2
+        exit 1
+    fi
+done
+
+fusermount3 -u "${FUSE_MNT}"
+wait "${FUSE_PID}" >/dev/null 2>&1 || true
+FUSE_PID=""
+
+# Every journal fdatasync must be preceded by a device sync once data has been written in place since the last one.
+if ! awk -v image="<${IMG_TRACED}>" -v journal="<${JOURNAL_TRACED}>" '
+    /resumed>/ { next }
+    index($0, image) && index($0, "pwritev") { unsynced = 1; written = 1; next }
+    index($0, image) && (index($0, "fdatasync(") || index($0, "fsync(")) { unsynced = 0; next }
+    index($0, journal) && index($0, "fdatasync(") {
+        if (unsynced) { print "journal fdatasync before device sync: " $0; bad = 1 }
+        if (written) { checked++ }
+        written = 0
+    }
+    END { if (checked == 0) { print "no journal flush followed an in-place data write"; bad = 1 } exit bad }
+' "${TRACE_LOG}" >&2; then
+    echo "FAIL: ordered data was not synced before the journal record became durable" >&2
+    exit 1
+fi
+
+echo "PASS: ordered data reaches the device before the journal"
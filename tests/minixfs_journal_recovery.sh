@@ -0,0 +1,226 @@
+#!/usr/bin/env bash
+set -euo pipefail
+export LC_ALL=C
+export LANG=C
+
+if [[ $# -ne 3 ]]; then
+    echo "Usage: $0 <minixfs-fuse-bin> <fixture-dir> <work-dir>" >&2
+    exit 2
+fi
+
+FUSE_BIN="$1"
+FIXTURE_DIR="$2"
+WORK_DIR="$3"
+
+require_cmd() {
+    if ! command -v "$1" >/dev/null 2>&1; then
+        echo "SKIP: missing command '$1'" >&2
+        exit 77
+    fi
+}
+
+require_cmd mountpoint
+require_cmd fusermount3
+require_cmd stat
+require_cmd dd
+require_cmd cmp
+require_cmd head
+require_cmd truncate
+require_cmd sync
+require_cmd grep
+
+if [[ ! -x "${FUSE_BIN}" ]]; then
+    echo "FAIL: fuse binary not executable: ${FUSE_BIN}" >&2
+    exit 1
+fi
+
+if [[ ! -r "${FIXTURE_DIR}/disk.img" ]]; then
+    echo "SKIP: fixture not found, run tests/generate_minixfs_write_fixture.sh first" >&2
+    exit 77
+fi
+if [[ ! -r "${FIXTURE_DIR}/expected/hello.txt" ]]; then
+    echo "SKIP: fixture missing expected/hello.txt, run tests/generate_minixfs_write_fixture.sh first" >&2
+    exit 77
+fi
+
+IMG_SRC="${FIXTURE_DIR}/disk.img"
+IMG_RUN="${WORK_DIR}/disk.img"
+JOURNAL_RUN="${WORK_DIR}/disk.journal"
+FUSE_MNT="${WORK_DIR}/fuse_mnt"
+FUSE_LOG="${WORK_DIR}/fuse.log"
+SRC_DIR="${WORK_DIR}/src"
+HELLO_EXPECTED_CONTENT="$(cat "${FIXTURE_DIR}/expected/hello.txt")"
+CHUNK=131072
+
+FUSE_PID=""
+cleanup() {
+    set +e
+    if [[ -d "${FUSE_MNT}" ]]; then
+        fusermount3 -u -z "${FUSE_MNT}" >/dev/null 2>&1 || true
+    fi
+    if [[ -n "${FUSE_PID}" ]]; then
+        kill "${FUSE_PID}" >/dev/null 2>&1 || true
+        wait "${FUSE_PID}" >/dev/null 2>&1 || true
+    fi
+}
+trap cleanup EXIT
+
+mount_fuse() {
+    local image="$1"
+    local journal="$2"
+    shift 2
+    "${FUSE_BIN}" -f --device="${image}" --journal="${journal}" "$@" "${FUSE_MNT}" >"${FUSE_LOG}" 2>&1 &
+    FUSE_PID=$!
+    for _ in $(seq 1 50); do
+        if mountpoint -q "${FUSE_MNT}"; then
+            return 0
+        fi
+        sleep 0.1
+    done
+    echo "FAIL: fuse mount did not come up; log:" >&2
+    sed -n '1,120p' "${FUSE_LOG}" >&2 || true
+    exit 1
+}
+
+unmount_fuse() {
+    fusermount3 -u "${FUSE_MNT}"
+    wait "${FUSE_PID}" >/dev/null 2>&1 || true
+    FUSE_PID=""
+}
+
+crash_fuse() {
+    kill -9 "${FUSE_PID}"
+    wait "${FUSE_PID}" >/dev/null 2>&1 || true
+    FUSE_PID=""
+    fusermount3 -u -z "${FUSE_MNT}" >/dev/null 2>&1 || true
+}
+
+file_size() {
+    stat -c '%s' "$1"
+}
+
+copy_in() {
+    dd if="$1" of="$2" bs="${CHUNK}" status=none
+}
+
+expect_same() {
+    if ! cmp -s "$1" "$2"; then
+        echo "FAIL: $3" >&2
+        exit 1
+    fi
+}
+
+check_image() {
+    local image="$1"
+    if ! command -v fsck.minix >/dev/null 2>&1; then
+        return 0
+    fi
+    fsck.minix -f "${image}" >"${WORK_DIR}/fsck.log" 2>&1 || true
+    if grep -v -e 'Forcing filesystem check' -e 'marked in use, no file uses it' "${WORK_DIR}/fsck.log" | grep -q .; then
+        echo "FAIL: fsck.minix reported errors on ${image}:" >&2
+        sed -n '1,40p' "${WORK_DIR}/fsck.log" >&2 || true
+        exit 1
+    fi
+}
+
+if [[ -d "${FUSE_MNT}" ]]; then
+    fusermount3 -u -z "${FUSE_MNT}" >/dev/null 2>&1 || true
+fi
+rm -rf "${WORK_DIR}"
+mkdir -p "${FUSE_MNT}" "${SRC_DIR}"
+for name in durable a_first a_second b; do
+    head -c $((8 * CHUNK)) /dev/urandom > "${SRC_DIR}/${name}"
+done
+head -c "${CHUNK}" /dev/urandom > "${SRC_DIR}/durable_head"
+
+cp "${IMG_SRC}" "${IMG_RUN}"
+mount_fuse "${IMG_RUN}" "${JOURNAL_RUN}"
+copy_in "${SRC_DIR}/durable" "${FUSE_MNT}/clean.bin"
+unmount_fuse
+if [[ "$(file_size "${JOURNAL_RUN}")" != "0" ]]; then
+    echo "FAIL: clean unmount should leave an empty journal" >&2
+    exit 1
+fi
+check_image "${IMG_RUN}"
+mount_fuse "${IMG_RUN}" "${JOURNAL_RUN}"
+expect_same "${SRC_DIR}/durable" "${FUSE_MNT}/clean.bin" "file written with --journal mismatch after clean remount"
+if [[ "$(cat "${FUSE_MNT}/hello.txt")" != "${HELLO_EXPECTED_CONTENT}" ]]; then
+    echo "FAIL: fixture content changed under --journal" >&2
+    exit 1
+fi
+unmount_fuse
+
+rm -f "${JOURNAL_RUN}"
+cp "${IMG_SRC}" "${IMG_RUN}"
+mount_fuse "${IMG_RUN}" "${JOURNAL_RUN}" --cache-blocks=64
+copy_in "${SRC_DIR}/durable" "${FUSE_MNT}/durable.bin"
+sync "${FUSE_MNT}/durable.bin"
+if [[ "$(file_size "${JOURNAL_RUN}")" != "0" ]]; then
+    echo "FAIL: fsync should checkpoint and empty the journal" >&2
+    exit 1
+fi
+copy_in "${SRC_DIR}/a_first" "${FUSE_MNT}/a.bin"
+copy_in "${SRC_DIR}/b" "${FUSE_MNT}/b.bin"
+if [[ "$(file_size "${JOURNAL_RUN}")" == "0" ]]; then
+    echo "FAIL: committed transactions should be logged to the journal" >&2
+    exit 1
+fi
+crash_fuse
+
+cp "${IMG_RUN}" "${WORK_DIR}/torn.img"
+cp "${JOURNAL_RUN}" "${WORK_DIR}/torn.journal"
+truncate -s -100 "${WORK_DIR}/torn.journal"
+
+mount_fuse "${IMG_RUN}" "${JOURNAL_RUN}"
+if [[ "$(file_size "${JOURNAL_RUN}")" != "0" ]]; then
+    echo "FAIL: replay should empty the journal at mount" >&2
+    exit 1
+fi
+expect_same "${SRC_DIR}/durable" "${FUSE_MNT}/durable.bin" "fsynced file mismatch after crash replay"
+expect_same "${SRC_DIR}/a_first" "${FUSE_MNT}/a.bin" "journaled file a mismatch after crash replay"
+expect_same "${SRC_DIR}/b" "${FUSE_MNT}/b.bin" "journaled file b mismatch after crash replay"
+unmount_fuse
+check_image "${IMG_RUN}"
+
+mount_fuse "${WORK_DIR}/torn.img" "${WORK_DIR}/torn.journal"
+if [[ "$(file_size "${WORK_DIR}/torn.journal")" != "0" ]]; then
+    echo "FAIL: replay of a torn journal should still empty it at mount" >&2
+    exit 1
+fi
+expect_same "${SRC_DIR}/durable" "${FUSE_MNT}/durable.bin" "fsynced file mismatch after torn journal replay"
+expect_same "${SRC_DIR}/a_first" "${FUSE_MNT}/a.bin" "file a mismatch after torn journal replay"
+unmount_fuse
+check_image "${WORK_DIR}/torn.img"
+
+rm -f "${JOURNAL_RUN}"
+cp "${IMG_SRC}" "${IMG_RUN}"
+mount_fuse "${IMG_RUN}" "${JOURNAL_RUN}" --cache-blocks=64 --ordered-data
+copy_in "${SRC_DIR}/durable" "${FUSE_MNT}/durable.bin"
+sync "${FUSE_MNT}/durable.bin"
+copy_in "${SRC_DIR}/a_first" "${FUSE_MNT}/a.bin"
+dd if="${SRC_DIR}/a_second" of="${FUSE_MNT}/a.bin" bs="${CHUNK}" conv=notrunc status=none
+JOURNAL_BEFORE_REUSE="$(file_size "${JOURNAL_RUN}")"
+if [[ "${JOURNAL_BEFORE_REUSE}" == "0" ]]; then
+    echo "FAIL: overwriting allocated zones should be logged to the journal" >&2
+    exit 1
+fi
+rm "${FUSE_MNT}/a.bin"
+copy_in "${SRC_DIR}/b" "${FUSE_MNT}/b.bin"
+if [[ "$(file_size "${JOURNAL_RUN}")" -ge "${JOURNAL_BEFORE_REUSE}" ]]; then
+    echo "FAIL: ordered write into journaled zones should checkpoint the journal" >&2
+    exit 1
+fi
+dd if="${SRC_DIR}/durable_head" of="${FUSE_MNT}/durable.bin" bs="${CHUNK}" conv=notrunc status=none
+crash_fuse
+
+mount_fuse "${IMG_RUN}" "${JOURNAL_RUN}" --ordered-data
+expect_same "${SRC_DIR}/b" "${FUSE_MNT}/b.bin" "ordered write into reused zones was overwritten by replay"
+expect_same "${SRC_DIR}/durable_head" <(head -c "${CHUNK}" "${FUSE_MNT}/durable.bin") "journaled overwrite mismatch after ordered replay"
+if [[ -e "${FUSE_MNT}/a.bin" ]]; then
+    echo "FAIL: unlinked file should stay deleted after replay" >&2
+    exit 1
+fi
+unmount_fuse
+check_image "${IMG_RUN}"
+
+echo "PASS: journal replay and recovery behavior is correct"
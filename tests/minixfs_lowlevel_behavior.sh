@@ -0,0 +1,226 @@
+#!/usr/bin/env bash
+set -euo pipefail
+export LC_ALL=C
+export LANG=C
+
+if [[ $# -ne 3 ]]; then
+    echo "Usage: $0 <minixfs-fuse-ll-bin> <fixture-dir> <work-dir>" >&2
+    exit 2
+fi
+
+FUSE_BIN="$1"
+FIXTURE_DIR="$2"
+WORK_DIR="$3"
+
+require_cmd() {
+    if ! command -v "$1" >/dev/null 2>&1; then
+        echo "SKIP: missing command '$1'" >&2
+        exit 77
+    fi
+}
+
+require_cmd mountpoint
+require_cmd fusermount3
+require_cmd stat
+require_cmd ls
+require_cmd mkfifo
+require_cmd cat
+
+if [[ ! -x "${FUSE_BIN}" ]]; then
+    echo "FAIL: fuse binary not executable: ${FUSE_BIN}" >&2
+    exit 1
+fi
+
+if [[ ! -r "${FIXTURE_DIR}/disk.img" ]]; then
+    echo "SKIP: fixture not found, run tests/generate_minixfs_write_fixture.sh first" >&2
+    exit 77
+fi
+
+IMG_SRC="${FIXTURE_DIR}/disk.img"
+IMG_RUN="${WORK_DIR}/disk.img"
+FUSE_MNT="${WORK_DIR}/fuse_mnt"
+FUSE_LOG="${WORK_DIR}/fuse.log"
+
+FUSE_PID=""
+cleanup() {
+    set +e
+    exec 3<&- 2>/dev/null
+    if [[ -d "${FUSE_MNT}" ]]; then
+        fusermount3 -u -z "${FUSE_MNT}" >/dev/null 2>&1 || true
+    fi
+    if [[ -n "${FUSE_PID}" ]]; then
+        kill "${FUSE_PID}" >/dev/null 2>&1 || true
+        wait "${FUSE_PID}" >/dev/null 2>&1 || true
+    fi
+}
+trap cleanup EXIT
+
+mount_fuse() {
+    "${FUSE_BIN}" -f --device="${IMG_RUN}" "${FUSE_MNT}" >"${FUSE_LOG}" 2>&1 &
+    FUSE_PID=$!
+    for _ in $(seq 1 50); do
+        if mountpoint -q "${FUSE_MNT}"; then
+            return 0
+        fi
+        sleep 0.1
+    done
+    return 1
+}
+
+remount_fuse() {
+    fusermount3 -u -z "${FUSE_MNT}"
+    wait "${FUSE_PID}" >/dev/null 2>&1 || true
+    FUSE_PID=""
+    if ! mount_fuse; then
+        echo "FAIL: fuse remount did not come up; log:" >&2
+        sed -n '1,120p' "${FUSE_LOG}" >&2 || true
+        exit 1
+    fi
+}
+
+free_inodes() {
+    stat -f -c '%d' "${FUSE_MNT}"
+}
+
+wait_free_inodes() {
+    local expected="$1"
+    for _ in $(seq 1 50); do
+        if [[ "$(free_inodes)" == "${expected}" ]]; then
+            return 0
+        fi
+        sleep 0.1
+    done
+    return 1
+}
+
+if [[ -d "${FUSE_MNT}" ]]; then
+    fusermount3 -u -z "${FUSE_MNT}" >/dev/null 2>&1 || true
+fi
+rm -rf "${WORK_DIR}"
+mkdir -p "${FUSE_MNT}"
+cp "${IMG_SRC}" "${IMG_RUN}"
+
+if ! mount_fuse; then
+    echo "FAIL: fuse mount did not come up; log:" >&2
+    sed -n '1,120p' "${FUSE_LOG}" >&2 || true
+    exit 1
+fi
+
+FFREE_BASE="$(free_inodes)"
+
+NEGATIVE_TARGET="${FUSE_MNT}/negative_case.txt"
+if stat "${NEGATIVE_TARGET}" >/dev/null 2>&1; then
+    echo "FAIL: lookup of a missing name should fail" >&2
+    exit 1
+fi
+printf "NOW-EXISTS" > "${NEGATIVE_TARGET}"
+if [[ "$(cat "${NEGATIVE_TARGET}")" != "NOW-EXISTS" ]]; then
+    echo "FAIL: create after a negative lookup should be visible" >&2
+    exit 1
+fi
+rm "${NEGATIVE_TARGET}"
+if stat "${NEGATIVE_TARGET}" >/dev/null 2>&1; then
+    echo "FAIL: unlinked name should not resolve" >&2
+    exit 1
+fi
+if ! wait_free_inodes "${FFREE_BASE}"; then
+    echo "FAIL: create+unlink should free the inode once forgotten: before=${FFREE_BASE}, after=$(free_inodes)" >&2
+    exit 1
+fi
+
+OPEN_TARGET="${FUSE_MNT}/open_unlinked_case.txt"
+printf "STILL-OPEN" > "${OPEN_TARGET}"
+exec 3<"${OPEN_TARGET}"
+rm "${OPEN_TARGET}"
+if [[ -e "${OPEN_TARGET}" ]]; then
+    echo "FAIL: unlinked open file should not have a name" >&2
+    exit 1
+fi
+if [[ "$(cat <&3)" != "STILL-OPEN" ]]; then
+    echo "FAIL: unlinked open file should stay readable" >&2
+    exit 1
+fi
+if [[ "$(free_inodes)" == "${FFREE_BASE}" ]]; then
+    echo "FAIL: unlinked open file should keep its inode allocated" >&2
+    exit 1
+fi
+exec 3<&-
+if ! wait_free_inodes "${FFREE_BASE}"; then
+    echo "FAIL: closing the last reference should free the inode: before=${FFREE_BASE}, after=$(free_inodes)" >&2
+    exit 1
+fi
+
+LINK_SRC="${FUSE_MNT}/link_src.txt"
+LINK_DST="${FUSE_MNT}/link_dst.txt"
+printf "LINKED" > "${LINK_SRC}"
+ln "${LINK_SRC}" "${LINK_DST}"
+if [[ "$(stat -c '%i %h' "${LINK_SRC}")" != "$(stat -c '%i %h' "${LINK_DST}")" ]]; then
+    echo "FAIL: hard links should share inode and link count" >&2
+    exit 1
+fi
+rm "${LINK_SRC}"
+if [[ "$(cat "${LINK_DST}")" != "LINKED" ]]; then
+    echo "FAIL: remaining hard link content mismatch" >&2
+    exit 1
+fi
+rm "${LINK_DST}"
+if ! wait_free_inodes "${FFREE_BASE}"; then
+    echo "FAIL: unlinking every hard link should free the inode: before=${FFREE_BASE}, after=$(free_inodes)" >&2
+    exit 1
+fi
+
+PLUS_DIR="${FUSE_MNT}/readdirplus_case"
+PLUS_FILES=300
+mkdir "${PLUS_DIR}"
+for i in $(seq 1 "${PLUS_FILES}"); do
+    printf "%s" "${i}" > "${PLUS_DIR}/file_${i}"
+done
+remount_fuse
+LISTED="$(ls -l "${PLUS_DIR}" | grep -c ' file_' || true)"
+if [[ "${LISTED}" != "${PLUS_FILES}" ]]; then
+    echo "FAIL: readdirplus should list every entry: expected=${PLUS_FILES}, got=${LISTED}" >&2
+    exit 1
+fi
+for i in 1 150 "${PLUS_FILES}"; do
+    if [[ "$(stat -c '%s' "${PLUS_DIR}/file_${i}")" != "${#i}" ]]; then
+        echo "FAIL: readdirplus attributes mismatch for file_${i}" >&2
+        exit 1
+    fi
+done
+rm -r "${PLUS_DIR}"
+if [[ -e "${PLUS_DIR}" ]]; then
+    echo "FAIL: directory should be removed" >&2
+    exit 1
+fi
+if ! wait_free_inodes "${FFREE_BASE}"; then
+    echo "FAIL: entries returned by readdirplus should be freed once forgotten: before=${FFREE_BASE}, after=$(free_inodes)" >&2
+    exit 1
+fi
+
+FIFO_TARGET="${FUSE_MNT}/fifo_case"
+if mkfifo "${FIFO_TARGET}" 2>/dev/null; then
+    echo "FAIL: mknod of a fifo should fail with ENOSYS" >&2
+    exit 1
+fi
+if [[ -e "${FIFO_TARGET}" ]]; then
+    echo "FAIL: failed mknod should not leave an entry" >&2
+    exit 1
+fi
+if [[ "$(free_inodes)" != "${FFREE_BASE}" ]]; then
+    echo "FAIL: failed mknod should not allocate an inode" >&2
+    exit 1
+fi
+
+sync
+remount_fuse
+
+if [[ "$(free_inodes)" != "${FFREE_BASE}" ]]; then
+    echo "FAIL: free inode count mismatch after remount: before=${FFREE_BASE}, after=$(free_inodes)" >&2
+    exit 1
+fi
+if [[ -e "${PLUS_DIR}" || -e "${OPEN_TARGET}" || -e "${LINK_DST}" ]]; then
+    echo "FAIL: deleted entries should stay deleted after remount" >&2
+    exit 1
+fi
+
+echo "PASS: low-level frontend behavior is correct"
@@ -0,0 +1,105 @@
+#!/usr/bin/env bash
+set -euo pipefail
+export LC_ALL=C
+export LANG=C
+
+if [[ $# -ne 3 ]]; then
+    echo "Usage: $0 <minixfs-cli-bin> <fixture-dir> <work-dir>" >&2
+    exit 2
+fi
+
+CLI_BIN="$1"
+FIXTURE_DIR="$2"
+WORK_DIR="$3"
+
+require_cmd() {
+    if ! command -v "$1" >/dev/null 2>&1; then
+        echo "SKIP: missing command '$1'" >&2
+        exit 77
+    fi
+}
+
+require_cmd cmp
+require_cmd grep
+
+if [[ ! -x "${CLI_BIN}" ]]; then
+    echo "FAIL: cli binary not executable: ${CLI_BIN}" >&2
+    exit 1
+fi
+
+if [[ ! -r "${FIXTURE_DIR}/disk.img" ]]; then
+    echo "SKIP: fixture not found, run tests/generate_minixfs_write_fixture.sh first" >&2
+    exit 77
+fi
+if [[ ! -r "${FIXTURE_DIR}/expected/hello.txt" ]]; then
+    echo "SKIP: fixture missing expected/hello.txt, run tests/generate_minixfs_write_fixture.sh first" >&2
+    exit 77
+fi
+
+IMG_SRC="${FIXTURE_DIR}/disk.img"
+IMG_RUN="${WORK_DIR}/disk.img"
+IMG_SAVED="${WORK_DIR}/saved.img"
+CLI_OUT="${WORK_DIR}/cli.out"
+HELLO_EXPECTED_CONTENT="$(cat "${FIXTURE_DIR}/expected/hello.txt")"
+HELLO_OVERWRITTEN_CONTENT="RAM${HELLO_EXPECTED_CONTENT:3}"
+
+rm -rf "${WORK_DIR}"
+mkdir -p "${WORK_DIR}"
+cp "${IMG_SRC}" "${IMG_RUN}"
+
+"${CLI_BIN}" --ram="${IMG_SAVED}" "${IMG_RUN}" >"${CLI_OUT}" 2>&1 <<'EOF'
+cat /hello.txt
+mkdir /ram_dir
+write /ram_dir/note.txt RAM-BACKEND-NOTE
+write /hello.txt RAM
+cat /ram_dir/note.txt
+exit
+EOF
+if grep -q "Failed" "${CLI_OUT}"; then
+    echo "FAIL: operations on the RAM backend failed:" >&2
+    sed -n '1,40p' "${CLI_OUT}" >&2
+    exit 1
+fi
+if ! grep -q "RAM-BACKEND-NOTE" "${CLI_OUT}"; then
+    echo "FAIL: file written on the RAM backend should read back before save" >&2
+    exit 1
+fi
+if ! cmp -s "${IMG_SRC}" "${IMG_RUN}"; then
+    echo "FAIL: RAM backend should not modify the source image" >&2
+    exit 1
+fi
+if [[ ! -s "${IMG_SAVED}" ]]; then
+    echo "FAIL: RAM backend image was not saved" >&2
+    exit 1
+fi
+
+"${CLI_BIN}" "${IMG_SAVED}" >"${CLI_OUT}" 2>&1 <<'EOF'
+ls /ram_dir
+cat /ram_dir/note.txt
+cat /hello.txt
+exit
+EOF
+if grep -q "Failed" "${CLI_OUT}"; then
+    echo "FAIL: saved image could not be read back:" >&2
+    sed -n '1,40p' "${CLI_OUT}" >&2
+    exit 1
+fi
+if ! grep -qxF "note.txt" "${CLI_OUT}" || ! grep -q "RAM-BACKEND-NOTE" "${CLI_OUT}"; then
+    echo "FAIL: saved image is missing the file written on the RAM backend" >&2
+    exit 1
+fi
+if ! grep -qxF "minixfs> ${HELLO_OVERWRITTEN_CONTENT}" "${CLI_OUT}"; then
+    echo "FAIL: overwrite on the RAM backend was not saved" >&2
+    exit 1
+fi
+
+if command -v fsck.minix >/dev/null 2>&1; then
+    fsck.minix -f "${IMG_SAVED}" >"${WORK_DIR}/fsck.log" 2>&1 || true
+    if grep -v -e 'Forcing filesystem check' -e 'marked in use, no file uses it' "${WORK_DIR}/fsck.log" | grep -q .; then
+        echo "FAIL: fsck.minix reported errors on the saved image:" >&2
+        sed -n '1,40p' "${WORK_DIR}/fsck.log" >&2 || true
+        exit 1
+    fi
+fi
+
+echo "PASS: RAM backend mount, operations and save are correct"
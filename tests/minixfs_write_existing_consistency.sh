@@ -3,14 +3,16 @@ set -euo pipefail
 export LC_ALL=C
 export LANG=C
 
-if [[ $# -ne 3 ]]; then
-    echo "Usage: $0 <minixfs-fuse-bin> <fixture-dir> <work-dir>" >&2
+if [[ $# -lt 3 ]]; then
+    echo "Usage: $0 <minixfs-fuse-bin> <fixture-dir> <work-dir> [mount-option...]" >&2
     exit 2
 fi
 
 FUSE_BIN="$1"
 FIXTURE_DIR="$2"
 WORK_DIR="$3"
+shift 3
+MOUNT_OPTIONS=("$@")
 
 require_cmd() {
     if ! command -v "$1" >/dev/null 2>&1; then
@@ -77,7 +79,7 @@ mkdir -p "${FUSE_MNT}"
 cp "${IMG_SRC}" "${IMG_RUN}"
 
 mount_fuse() {
-    "${FUSE_BIN}" -f --device="${IMG_RUN}" "${FUSE_MNT}" >"${FUSE_LOG}" 2>&1 &
+    "${FUSE_BIN}" -f --device="${IMG_RUN}" "${MOUNT_OPTIONS[@]}" "${FUSE_MNT}" >"${FUSE_LOG}" 2>&1 &
     FUSE_PID=$!
     for _ in $(seq 1 50); do
         if mountpoint -q "${FUSE_MNT}"; then
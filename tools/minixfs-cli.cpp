@@ -1,16 +1,36 @@
 #include <iostream>
+#include <memory>
+#include <sys/stat.h>
 #include "FS.h"
+#include "RamBackend.h"
 #include "Utils.h"
 
 int main(int argc, char **argv)
 {
-	if (argc != 2)
+	std::string ramOption = "--ram=";
+	std::string savePath;
+	if (argc == 3 && std::string(argv[1]).rfind(ramOption, 0) == 0)
 	{
-		std::cerr << "Usage: " << argv[0] << " <minixfs_device>" << std::endl;
+		savePath = std::string(argv[1]).substr(ramOption.size());
+	}
+	if ((argc != 2 && argc != 3) || (argc == 3 && savePath.empty()))
+	{
+		std::cerr << "Usage: " << argv[0] << " [--ram=<output_image>] <minixfs_device>" << std::endl;
 		return 1;
 	}
-	std::string devicePath = argv[1];
-	FS filesystem(devicePath);
+	std::string devicePath = argv[argc - 1];
+	RamBackend *ramBackend = nullptr;
+	std::unique_ptr<FS> fs;
+	if (savePath.empty())
+	{
+		fs.reset(new FS(devicePath));
+	}
+	else
+	{
+		ramBackend = new RamBackend(devicePath);
+		fs.reset(new FS(std::unique_ptr<BlockBackend>(ramBackend)));
+	}
+	FS &filesystem = *fs;
 	ErrorCode err = filesystem.mount();
 	if (err != SUCCESS)
 	{
@@ -75,9 +95,60 @@ int main(int argc, char **argv)
 			}
 			std::cout << std::endl;
 		}
+		else if (commandLine.rfind("mkdir ", 0) == 0)
+		{
+			std::string path = commandLine.substr(6);
+			ErrorCode err = filesystem.mkdir(path, 0755, 0, 0);
+			if (err != SUCCESS)
+			{
+				std::cout << "Failed to create directory. Error code: " << err << std::endl;
+			}
+		}
+		else if (commandLine.rfind("write ", 0) == 0)
+		{
+			size_t separator = commandLine.find(' ', 6);
+			if (separator == std::string::npos)
+			{
+				std::cout << "Usage: write <path> <text>" << std::endl;
+				continue;
+			}
+			std::string path = commandLine.substr(6, separator - 6);
+			std::string text = commandLine.substr(separator + 1);
+			ErrorCode err;
+			filesystem.getFileStat(path, err);
+			if (err == ERROR_FILE_NOT_FOUND)
+			{
+				auto [parentPath, name] = splitPathIntoDirAndBase(path);
+				filesystem.createFile(parentPath, name, S_IFREG | 0644, 0, 0, err);
+			}
+			if (err == SUCCESS)
+			{
+				filesystem.writeFile(path, reinterpret_cast<const uint8_t*>(text.data()), 0, static_cast<uint32_t>(text.size()), err);
+			}
+			if (err != SUCCESS)
+			{
+				std::cout << "Failed to write file. Error code: " << err << std::endl;
+			}
+		}
 		else
 		{
 			std::cout << "Unknown command." << std::endl;
 		}
 	}
+	err = filesystem.unmount();
+	if (err != SUCCESS)
+	{
+		std::cerr << "Failed to unmount filesystem. Error code: " << err << std::endl;
+		return 1;
+	}
+	if (ramBackend != nullptr)
+	{
+		err = ramBackend->save(savePath);
+		if (err != SUCCESS)
+		{
+			std::cerr << "Failed to save image. Error code: " << err << std::endl;
+			return 1;
+		}
+	}
+	return 0;
 }
\ No newline at end of file